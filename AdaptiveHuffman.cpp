@@ -0,0 +1,142 @@
+#include "AdaptiveHuffman.h"
+#include <string>
+#include <utility>
+
+AdaptiveHuffman::AdaptiveHuffman() : nodes_(1), order_{ROOT}, rank_{0} {}
+
+void AdaptiveHuffman::encode(std::string_view word, BitWriter& writer) {
+    const std::uint32_t id = words_.intern(word);
+    if (id < leafOf_.size()) {
+        const std::int32_t leaf = leafOf_[id];
+        putCode(leaf, writer);
+        update(leaf);
+        return;
+    }
+    putCode(nyt_, writer);
+    putLiteral(writer, word);
+    update(addWord(id));
+}
+
+void AdaptiveHuffman::finish(BitWriter& writer) {
+    putCode(nyt_, writer);
+    putLiteral(writer, {});
+    writer.alignToByte();
+}
+
+error_type AdaptiveHuffman::decode(BitReader& reader, std::string_view& word) {
+    std::int32_t node = ROOT;
+    while (nodes_[node].left >= 0) {
+        if (reader.remaining() == 0) {
+            return CORRUPT_CODE_FILE;
+        }
+        node = reader.peek(1) ? nodes_[node].right : nodes_[node].left;
+        reader.skip(1);
+    }
+    if (node != nyt_) {
+        word = words_.word(static_cast<std::uint32_t>(nodes_[node].word));
+        update(node);
+        return NO_ERROR;
+    }
+
+    std::string literal;
+    if (!readLiteral(reader, literal)) {
+        return CORRUPT_CODE_FILE;
+    }
+    if (literal.empty()) {
+        word = {};
+        return NO_ERROR;
+    }
+    const std::uint32_t id = words_.intern(literal);
+    if (id < leafOf_.size()) {
+        return CORRUPT_CODE_FILE; // a known word never comes as a literal
+    }
+    word = words_.word(id);
+    update(addWord(id));
+    return NO_ERROR;
+}
+
+// Write the path from the root to 'node'. It is collected bottom-up, so the
+// last bit lands lowest; paths past 64 bits are written in pieces.
+void AdaptiveHuffman::putCode(std::int32_t node, BitWriter& writer) {
+    BitCode code;
+    for (; node != ROOT; node = nodes_[node].parent) {
+        if (code.length == BitCode::MAX_LENGTH) {
+            spill_.push_back(code);
+            code = BitCode{};
+        }
+        if (nodes_[nodes_[node].parent].right == node) {
+            code.bits |= std::uint64_t{1} << code.length;
+        }
+        ++code.length;
+    }
+    if (code.length > 0) {
+        writer.putBits(code);
+    }
+    for (; !spill_.empty(); spill_.pop_back()) {
+        writer.putBits(spill_.back());
+    }
+}
+
+// Split the NYT leaf into a new NYT (left) and a leaf for word 'id' (right),
+// both of weight 0. Returns the new leaf.
+std::int32_t AdaptiveHuffman::addWord(std::uint32_t id) {
+    const std::int32_t parent = nyt_;
+    const auto leaf = static_cast<std::int32_t>(nodes_.size());
+    const std::int32_t nyt = leaf + 1;
+    nodes_.push_back(Node{.parent = parent, .word = static_cast<std::int32_t>(id)});
+    nodes_.push_back(Node{.parent = parent});
+    nodes_[parent].left = nyt;
+    nodes_[parent].right = leaf;
+    order_.push_back(leaf);
+    order_.push_back(nyt);
+    rank_.push_back(static_cast<std::int32_t>(order_.size() - 2));
+    rank_.push_back(static_cast<std::int32_t>(order_.size() - 1));
+    leafOf_.push_back(leaf);
+    nyt_ = nyt;
+    return leaf;
+}
+
+// Add one to the weights from 'node' up to the root, moving each node to
+// the front of its weight block first so the order stays non-increasing
+void AdaptiveHuffman::update(std::int32_t node) {
+    for (; node >= 0; node = nodes_[node].parent) {
+        const std::uint64_t weight = nodes_[node].weight;
+
+        // First position holding this weight. Only order_[0..rank] is
+        // searched: the child just incremented may sit right after 'node'
+        std::int32_t lo = 0;
+        std::int32_t hi = rank_[node];
+        while (lo < hi) {
+            const std::int32_t mid = lo + (hi - lo) / 2;
+            if (nodes_[order_[mid]].weight > weight) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        // A node never trades places with its own parent (same weight only
+        // when the sibling is the NYT); the next one in the block stands in
+        if (order_[lo] == nodes_[node].parent) {
+            ++lo;
+        }
+        if (order_[lo] != node) {
+            swapNodes(node, order_[lo]);
+        }
+        ++nodes_[node].weight;
+    }
+}
+
+// Exchange two subtrees (neither contains the other) and their places in order_
+void AdaptiveHuffman::swapNodes(std::int32_t a, std::int32_t b) {
+    Node& na = nodes_[a];
+    Node& nb = nodes_[b];
+    if (na.parent == nb.parent) {
+        std::swap(nodes_[na.parent].left, nodes_[na.parent].right);
+    } else {
+        (nodes_[na.parent].left == a ? nodes_[na.parent].left : nodes_[na.parent].right) = b;
+        (nodes_[nb.parent].left == b ? nodes_[nb.parent].left : nodes_[nb.parent].right) = a;
+        std::swap(na.parent, nb.parent);
+    }
+    std::swap(order_[rank_[a]], order_[rank_[b]]);
+    std::swap(rank_[a], rank_[b]);
+}
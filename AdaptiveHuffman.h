@@ -0,0 +1,68 @@
+#ifndef ADAPTIVEHUFFMAN_H
+#define ADAPTIVEHUFFMAN_H
+
+#pragma once
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "BitStream.h"
+#include "StringInterner.h"
+#include "utils.hpp"
+
+// One-pass (adaptive) Huffman coding of words, FGK algorithm. Encoder and
+// decoder start from the same tree (just the NYT, "not yet transmitted",
+// leaf) and apply the same update after every word, so no header is needed
+// and each word's bits can go out as soon as it is read.
+//
+// A word seen before is sent as its current code. A new word is sent as the
+// NYT code followed by its literal (see putLiteral), and the NYT leaf splits
+// into a new NYT and the word's leaf. The stream ends with the NYT code and
+// an empty literal (scanner tokens are never empty), padded to a byte.
+//
+// The tree keeps the sibling property: order_ lists the nodes by
+// non-increasing weight with every node's sibling next to it. Before a
+// node's weight goes up it trades places with the first node of its weight
+// (the block leader), found by binary search in order_, so an update costs
+// O(depth * log nodes).
+class AdaptiveHuffman {
+public:
+    AdaptiveHuffman();
+
+    // Write 'word''s code (or NYT + literal) and update the tree.
+    void encode(std::string_view word, BitWriter& writer);
+
+    // Write the end-of-stream marker and pad to a byte. The caller flushes.
+    void finish(BitWriter& writer);
+
+    // Read one word and update the tree. At the end-of-stream marker 'word'
+    // comes back empty. CORRUPT_CODE_FILE if the bits run out first.
+    error_type decode(BitReader& reader, std::string_view& word);
+
+    [[nodiscard]] std::size_t wordCount() const noexcept { return words_.size(); }
+    [[nodiscard]] std::uint64_t tokenCount() const noexcept { return nodes_[ROOT].weight; }
+
+private:
+    struct Node {
+        std::uint64_t weight = 0;
+        std::int32_t parent = -1;
+        std::int32_t left = -1;   // -1 at a leaf
+        std::int32_t right = -1;
+        std::int32_t word = -1;   // leaf's word ID; -1 for the NYT and internal nodes
+    };
+    static constexpr std::int32_t ROOT = 0;
+
+    std::vector<Node> nodes_;
+    std::vector<std::int32_t> order_;   // node indices, weights non-increasing; order_[0] is the root
+    std::vector<std::int32_t> rank_;    // rank_[node] = position of node in order_
+    std::vector<std::int32_t> leafOf_;  // leaf node of each word ID
+    StringInterner words_;
+    std::int32_t nyt_ = ROOT;
+    std::vector<BitCode> spill_;        // code pieces of paths deeper than 64 bits
+
+    void putCode(std::int32_t node, BitWriter& writer);
+    std::int32_t addWord(std::uint32_t id);
+    void update(std::int32_t node);
+    void swapNodes(std::int32_t a, std::int32_t b);
+};
+
+#endif //ADAPTIVEHUFFMAN_H
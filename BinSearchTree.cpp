@@ -10,26 +10,51 @@
 #include <optional>
 #include <string_view>
 #include <iostream>
-
-// ================================
-// Constructor / Destructor
-// ================================
-BinSearchTree::~BinSearchTree() {
-    destroy(root_);
-    root_ = nullptr;
-}
-
-
-
-
+#include <algorithm>
 
 // ================================
 // Public member functions
 // ================================
 
-void BinSearchTree::insert(const std::string& word) {
-    // root_ is always the top of the tree
-    root_ = insertHelper(root_, word);
+void BinSearchTree::insert(std::string_view word) {
+    // Walk down from root_, remembering each link we followed so the
+    // heights (and, for AVL, the shape) can be fixed on the way back up
+    std::vector<TreeNode**>& path = path_;
+    path.clear();
+    TreeNode** link = &root_;
+    while (*link != nullptr) {
+        TreeNode* node = *link;
+        if (word < node->key_word) {
+            path.push_back(link);
+            link = &node->left;
+        }
+        else if (word > node->key_word) {
+            path.push_back(link);
+            link = &node->right;
+        }
+        else { // If it is equal add to the count, shape is unchanged
+            node->freq++;
+            return;
+        }
+    }
+    *link = arena_.make(word); // Create new node
+    ++size_;
+
+    // Bottom-up: stop as soon as a subtree's height did not change,
+    // nothing above it can have changed either
+    for (auto it = path.rbegin(); it != path.rend(); ++it) {
+        TreeNode*& parent = **it;
+        const int before = parent->height;
+        if (balance_ == TreeBalance::AVL) {
+            rebalance(parent);
+        }
+        else {
+            updateHeight(parent);
+        }
+        if (parent->height == before) {
+            break;
+        }
+    }
 }
 
 
@@ -66,15 +91,32 @@ std::optional<int> BinSearchTree::countOf(std::string_view word) const noexcept
 }
 
 void BinSearchTree::inorderCollect(std::vector<std::pair<std::string, int>>& out) const {
-    inorderHelper(root_, out);
+    // Format L v R with an explicit stack of the nodes whose left side is in progress
+    out.reserve(out.size() + size_);
+    std::vector<const TreeNode*> stack;
+    const TreeNode* node = root_;
+    while (node != nullptr || !stack.empty()) {
+        // L: go as far left as possible
+        while (node != nullptr) {
+            stack.push_back(node);
+            node = node->left;
+        }
+        // v: Visit node
+        node = stack.back();
+        stack.pop_back();
+        out.emplace_back(node->key_word, node->freq);
+
+        // R: Traverse right subtree
+        node = node->right;
+    }
 }
 
 std::size_t BinSearchTree::size() const noexcept {
-    return sizeHelper(root_);
+    return size_;
 }
 
 unsigned BinSearchTree::height() const noexcept {
-    return heightHelper(root_);
+    return static_cast<unsigned>(heightOf(root_));
 }
 
 
@@ -86,59 +128,18 @@ unsigned BinSearchTree::height() const noexcept {
 // Private static helper functions
 // =================================
 
-void BinSearchTree::destroy(TreeNode* node) noexcept {
-    if (node == nullptr) {
-        return;
-    }
-    destroy(node->left);
-    destroy(node->right);
-    delete node;
-}
-
-TreeNode* BinSearchTree::insertHelper(TreeNode* node, const std::string& word) {
-
-    if (node == nullptr) {
-        return new TreeNode(word); // Create new node
-    }
-
-    // Compare the word with current node, if less, go left
-    if (word < node->key_word) {
-        node->left = insertHelper(node->left, word);
-    }
-    // Go right if greater
-    else if (word > node->key_word) {
-        node->right = insertHelper(node->right, word);
-    }
-    else { // If it is equal add to the count
-        node->freq++;
-    }
-
-    return node;
-}
-
-
-
-
-
 // Find the node containing 'word' or nullptr if not found
 const TreeNode* BinSearchTree::findNode(const TreeNode* node, std::string_view word) noexcept {
 
-    if (node == nullptr) {
-        return nullptr; // Not found
-    }
-
-    // word found return the node
-    if (word == node->key_word) {
-        return node;
-    }
-
-    // Search left or right based on comparison
-    if (word < node->key_word) {
-        return findNode(node->left, word);
-    }
-    else {
-        return findNode(node->right, word);
+    while (node != nullptr) {
+        // word found return the node
+        if (word == node->key_word) {
+            return node;
+        }
+        // Search left or right based on comparison
+        node = word < node->key_word ? node->left : node->right;
     }
+    return nullptr; // Not found
 }
 
 
@@ -146,40 +147,54 @@ const TreeNode* BinSearchTree::findNode(const TreeNode* node, std::string_view w
 
 
 
-// Format L v R where v will be the nodes value
-void BinSearchTree::inorderHelper(const TreeNode* node,
-                                  std::vector<std::pair<std::string, int>>& out) {
-
-    // Null
-    if (node == nullptr) {
-        return;
-    }
-    // L: Traverse left subtree
-    inorderHelper(node->left, out);
-
-    // v: Visit node
-    out.emplace_back(node->key_word, node->freq); // clion recommended emplace_back vs push_back
-
-    // R: Traverse right subtree
-    inorderHelper(node->right, out);
-
+int BinSearchTree::heightOf(const TreeNode* node) noexcept {
+    return node == nullptr ? 0 : node->height;
 }
 
-std::size_t BinSearchTree::sizeHelper(const TreeNode* node) noexcept {
+void BinSearchTree::updateHeight(TreeNode* node) noexcept {
+    // Root + the max height of left and right subtree (whichever is taller)
+    node->height = 1 + std::max(heightOf(node->left), heightOf(node->right));
+}
 
-    if (node == nullptr) {
-        return 0;
-    }
-    // Add up 1 + left subtree's and right subtree
-    return 1 + sizeHelper(node->left) + sizeHelper(node->right);
+// n with right child r  ->  r with left child n; r's old left subtree moves under n
+void BinSearchTree::rotateLeft(TreeNode*& link) noexcept {
+    TreeNode* node = link;
+    TreeNode* right = node->right;
+    node->right = right->left;
+    right->left = node;
+    updateHeight(node);
+    updateHeight(right);
+    link = right;
 }
 
-unsigned BinSearchTree::heightHelper(const TreeNode* node) noexcept {
+void BinSearchTree::rotateRight(TreeNode*& link) noexcept {
+    TreeNode* node = link;
+    TreeNode* left = node->left;
+    node->left = left->right;
+    left->right = node;
+    updateHeight(node);
+    updateHeight(left);
+    link = left;
+}
 
-    if (node == nullptr) {
-        return 0;
+// Restore |height(left) - height(right)| <= 1 at 'link' (children already balanced)
+void BinSearchTree::rebalance(TreeNode*& link) noexcept {
+    TreeNode* node = link;
+    const int skew = heightOf(node->left) - heightOf(node->right);
+    if (skew > 1) {
+        // Left-right case: turn it into left-left first
+        if (heightOf(node->left->left) < heightOf(node->left->right)) {
+            rotateLeft(node->left);
+        }
+        rotateRight(link);
     }
-
-    // Root + the max height of left and right subtree (whichever is taller)
-    return 1 + std::max(heightHelper(node->left), heightHelper(node->right));
-}
\ No newline at end of file
+    else if (skew < -1) {
+        if (heightOf(node->right->right) < heightOf(node->right->left)) {
+            rotateRight(node->right);
+        }
+        rotateLeft(link);
+    }
+    else {
+        updateHeight(node);
+    }
+}
@@ -7,19 +7,27 @@
 
 #pragma once
 #include <string>
+#include <string_view>
 #include <vector>
 #include <utility> // std::pair
 #include <optional>
+#include "NodeArena.h"
 
-struct TreeNode;  // Forward declaration (we can point to it)
+// Shape policy for BinSearchTree.
+//   NONE - plain BST; height depends on insertion order (sorted input = a list)
+//   AVL  - rotates after each insert so height stays <= ~1.44 log2(distinct)
+enum class TreeBalance { NONE, AVL };
 
 class BinSearchTree {
 public:
-    BinSearchTree() = default;
-    ~BinSearchTree(); // calls destroy(root_)
+    explicit BinSearchTree(TreeBalance balance = TreeBalance::NONE) : balance_(balance) {}
+    ~BinSearchTree() = default; // arena_ frees every node at once
+
+    BinSearchTree(const BinSearchTree&) = delete;
+    BinSearchTree& operator=(const BinSearchTree&) = delete;
 
     // Insert 'word'; if present, increment its count.
-    void insert(const std::string& word);
+    void insert(std::string_view word);
 
     // Convenience: loop over insert(word) for each token.
     void bulkInsert(const std::vector<std::string>& words);
@@ -32,21 +40,27 @@ public:
     void inorderCollect(std::vector<std::pair<std::string,int>>& out) const;
 
     // Metrics
+    // Both O(1): size is counted on insert, height is kept in the nodes
     [[nodiscard]] std::size_t size() const noexcept;  // distinct words
     [[nodiscard]] unsigned height() const noexcept;   // empty tree = 0
+    [[nodiscard]] TreeBalance balance() const noexcept { return balance_; }
 
 private:
     // TreeNode is defined elsewhere in the project
     TreeNode* root_ = nullptr;
+    std::size_t size_ = 0;
+    TreeBalance balance_;
+    NodeArena arena_;                 // owns every node
+    std::vector<TreeNode**> path_;    // insert()'s scratch, kept to avoid reallocating
 
-    // Helpers
-    static void destroy(TreeNode* node) noexcept;
-    static TreeNode* insertHelper(TreeNode* node, const std::string& word);
+    // Helpers. All loops, no recursion: a degenerate plain tree is as deep as
+    // it has words, which would overflow the call stack.
     static const TreeNode* findNode(const TreeNode* node, std::string_view word) noexcept;
-    static void inorderHelper(const TreeNode* node,
-                              std::vector<std::pair<std::string,int>>& out);
-    static std::size_t sizeHelper(const TreeNode* node) noexcept;
-    static unsigned heightHelper(const TreeNode* node) noexcept;
+    static int heightOf(const TreeNode* node) noexcept;
+    static void updateHeight(TreeNode* node) noexcept;
+    static void rotateLeft(TreeNode*& link) noexcept;
+    static void rotateRight(TreeNode*& link) noexcept;
+    static void rebalance(TreeNode*& link) noexcept;
 };
 
 #endif //BINSEARCHTREE_H
@@ -0,0 +1,292 @@
+#include "BitStream.h"
+#include <cstdint>
+#include <istream>
+#include <iterator>
+#include <ostream>
+#include <string>
+
+namespace {
+// Bytes collected before handing them to the ostream in one write() call.
+constexpr std::size_t BUFFER_BYTES = 1 << 16;
+}
+
+BitCode BitCode::fromString(std::string_view code) noexcept {
+    BitCode out;
+    for (char c : code) {
+        out.bits = (out.bits << 1) | (c == '1' ? 1 : 0);
+    }
+    out.length = static_cast<std::uint8_t>(code.size());
+    return out;
+}
+
+
+
+// ================================
+// BitWriter
+// ================================
+
+BitWriter::BitWriter(std::ostream& os) : os_(os), buffer_(BUFFER_BYTES) {}
+
+void BitWriter::putBit(bool bit) {
+    putBits(BitCode{bit ? 1u : 0u, 1});
+}
+
+void BitWriter::putBits(const std::string& code) {
+    // Up to 64 characters per integer step
+    const std::string_view text = code;
+    for (std::size_t i = 0; i < text.size(); i += BitCode::MAX_LENGTH) {
+        putBits(BitCode::fromString(text.substr(i, BitCode::MAX_LENGTH)));
+    }
+}
+
+void BitWriter::alignToByte() {
+    if (used_ % 8 != 0) {
+        putBits(BitCode{0, static_cast<std::uint8_t>(8 - used_ % 8)});
+    }
+}
+
+error_type BitWriter::flush() {
+    if (buffer_.size() - pos_ < 8) {
+        flushBuffer();
+    }
+    for (int i = used_ / 8 - 1; i >= 0; --i) {
+        buffer_[pos_++] = static_cast<char>(acc_ >> (8 * i));
+    }
+    acc_ = 0;
+    used_ = 0;
+    return flushBuffer() ? NO_ERROR : FAILED_TO_WRITE_FILE;
+}
+
+error_type BitWriter::drain() {
+    if (buffer_.size() - pos_ < 8) {
+        flushBuffer();
+    }
+    const int rest = used_ % 8;
+    for (int i = used_ / 8 - 1; i >= 0; --i) {
+        buffer_[pos_++] = static_cast<char>(acc_ >> (rest + 8 * i));
+    }
+    acc_ &= (std::uint64_t{1} << rest) - 1;
+    used_ = rest;
+    if (!flushBuffer() || !os_.flush()) {
+        return FAILED_TO_WRITE_FILE;
+    }
+    return NO_ERROR;
+}
+
+error_type BitWriter::finish() {
+    // Whole bytes of the accumulator, the last one padded with zeros on the right
+    if (buffer_.size() - pos_ < 16) {
+        flushBuffer();
+    }
+    if (used_ > 0) {
+        const std::uint64_t word = acc_ << (64 - used_);
+        for (int i = 0; i < (used_ + 7) / 8; ++i) {
+            buffer_[pos_++] = static_cast<char>(word >> (56 - 8 * i));
+        }
+        acc_ = 0;
+        used_ = 0;
+    }
+
+    // Trailer: number of valid bits, little-endian
+    for (std::size_t i = 0; i < TRAILER_BYTES; ++i) {
+        buffer_[pos_++] = static_cast<char>((total_ >> (8 * i)) & 0xFF);
+    }
+
+    return flushBuffer() ? NO_ERROR : FAILED_TO_WRITE_FILE;
+}
+
+std::uint64_t BitWriter::bitCount() const noexcept {
+    return total_;
+}
+
+bool BitWriter::flushBuffer() {
+    if (pos_ > 0) {
+        os_.write(buffer_.data(), static_cast<std::streamsize>(pos_));
+        pos_ = 0;
+    }
+    return static_cast<bool>(os_);
+}
+
+
+
+// ================================
+// TextBitWriter
+// ================================
+
+TextBitWriter::TextBitWriter(std::ostream& os, int wrapCols) : os_(os), wrapCols_(wrapCols) {
+    buffer_.reserve(BUFFER_BYTES);
+}
+
+void TextBitWriter::putBits(const std::string& code) {
+    for (char bit : code) {
+        buffer_.push_back(bit);
+        ++lineLength_;
+        if (lineLength_ == wrapCols_) {
+            buffer_.push_back('\n');
+            lineLength_ = 0;
+        }
+    }
+    total_ += code.size();
+    if (buffer_.size() >= BUFFER_BYTES) {
+        flushBuffer();
+    }
+}
+
+void TextBitWriter::putBits(BitCode code) {
+    for (int i = code.length - 1; i >= 0; --i) {
+        buffer_.push_back(((code.bits >> i) & 1) != 0 ? '1' : '0');
+        ++lineLength_;
+        if (lineLength_ == wrapCols_) {
+            buffer_.push_back('\n');
+            lineLength_ = 0;
+        }
+    }
+    total_ += code.length;
+    if (buffer_.size() >= BUFFER_BYTES) {
+        flushBuffer();
+    }
+}
+
+error_type TextBitWriter::finish() {
+    // end with new line
+    if (lineLength_ > 0) {
+        buffer_.push_back('\n');
+        lineLength_ = 0;
+    }
+    return flushBuffer() ? NO_ERROR : FAILED_TO_WRITE_FILE;
+}
+
+std::uint64_t TextBitWriter::bitCount() const noexcept {
+    return total_;
+}
+
+bool TextBitWriter::flushBuffer() {
+    if (!buffer_.empty()) {
+        os_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+        buffer_.clear();
+    }
+    return static_cast<bool>(os_);
+}
+
+
+
+// ================================
+// BitReader
+// ================================
+
+BitReader::BitReader(const unsigned char* data, std::size_t size, std::uint64_t bitCount) noexcept
+    : data_(data), size_(size), left_(bitCount) {
+    refill();
+}
+
+// Top up the window one byte at a time while there is room for a whole byte
+void BitReader::refill() noexcept {
+    while (count_ <= 56 && pos_ < size_) {
+        window_ |= static_cast<std::uint64_t>(data_[pos_++]) << (56 - count_);
+        count_ += 8;
+    }
+}
+
+std::uint32_t BitReader::peek(int n) noexcept {
+    if (count_ < n) {
+        refill();
+    }
+    return static_cast<std::uint32_t>(window_ >> (64 - n));
+}
+
+void BitReader::skip(int n) noexcept {
+    if (count_ < n) {
+        refill();
+    }
+    window_ <<= n;
+    count_ -= n;
+    left_ -= static_cast<std::uint64_t>(n);
+}
+
+std::uint64_t BitReader::remaining() const noexcept {
+    return left_;
+}
+
+bool readLiteral(BitReader& reader, std::string& word) {
+    // Elias gamma: 'zeros' zero bits, then the (zeros + 1)-bit length + 1
+    int zeros = 0;
+    while (reader.remaining() > 0 && reader.peek(1) == 0) {
+        if (++zeros > 31) {
+            return false;
+        }
+        reader.skip(1);
+    }
+    if (reader.remaining() < static_cast<std::uint64_t>(zeros + 1)) {
+        return false;
+    }
+    const std::uint32_t n = reader.peek(zeros + 1);
+    reader.skip(zeros + 1);
+    const std::uint32_t length = n - 1;
+    if (reader.remaining() < 8 * static_cast<std::uint64_t>(length)) {
+        return false;
+    }
+    word.resize(length);
+    for (std::uint32_t i = 0; i < length; ++i) {
+        word[i] = static_cast<char>(reader.peek(8));
+        reader.skip(8);
+    }
+    return true;
+}
+
+
+
+// ================================
+// .code file loading
+// ================================
+
+error_type readCodeFile(std::istream& is, CodeFormat format,
+                        std::vector<unsigned char>& bytes, std::uint64_t& bitCount) {
+    std::vector<char> raw((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+    bytes.clear();
+    bitCount = 0;
+
+    // Blocked files are read block by block instead (see readBlockIndex)
+    if (format == CodeFormat::BLOCKED) {
+        return CORRUPT_CODE_FILE;
+    }
+
+    if (format == CodeFormat::BINARY) {
+        if (raw.size() < BitWriter::TRAILER_BYTES) {
+            return CORRUPT_CODE_FILE;
+        }
+        const std::size_t payload = raw.size() - BitWriter::TRAILER_BYTES;
+        for (std::size_t i = 0; i < BitWriter::TRAILER_BYTES; ++i) {
+            bitCount |= static_cast<std::uint64_t>(static_cast<unsigned char>(raw[payload + i])) << (8 * i);
+        }
+        // The payload must hold exactly ceil(bitCount / 8) bytes
+        if ((bitCount + 7) / 8 != payload) {
+            return CORRUPT_CODE_FILE;
+        }
+        bytes.assign(raw.begin(), raw.begin() + static_cast<std::ptrdiff_t>(payload));
+        return NO_ERROR;
+    }
+
+    // ASCII: pack the '0'/'1' characters 8 per byte
+    bytes.reserve(raw.size() / 8 + 1);
+    unsigned char current = 0;
+    int used = 0;
+    for (char c : raw) {
+        if (c == '\n' || c == '\r') {
+            continue;
+        }
+        if (c != '0' && c != '1') {
+            return CORRUPT_CODE_FILE;
+        }
+        current = static_cast<unsigned char>((current << 1) | (c == '1' ? 1 : 0));
+        ++bitCount;
+        if (++used == 8) {
+            bytes.push_back(current);
+            current = 0;
+            used = 0;
+        }
+    }
+    if (used > 0) {
+        bytes.push_back(static_cast<unsigned char>(current << (8 - used)));
+    }
+    return NO_ERROR;
+}
@@ -0,0 +1,200 @@
+#ifndef BITSTREAM_H
+#define BITSTREAM_H
+
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "utils.hpp"
+
+// Layout of the <base>.code file written by HuffmanTree::encode.
+//   ASCII   - one '0'/'1' character per bit, wrapped to wrap_cols (compatibility format)
+//   BINARY  - bits packed 8 per byte plus a valid-bit-count trailer (see BitWriter)
+//   BLOCKED - fixed-size token blocks, each packed from a byte boundary, plus a
+//             footer index for seeking and parallel decode (see BlockCode.h)
+enum class CodeFormat { ASCII, BINARY, BLOCKED };
+
+// One Huffman code as an integer: the low 'length' bits of 'bits', first bit
+// of the code in the highest of them (code "110" = {0b110, 3}). Code tables
+// indexed by symbol hold these instead of '0'/'1' strings.
+struct BitCode {
+    std::uint64_t bits = 0;
+    std::uint8_t length = 0;
+
+    static constexpr int MAX_LENGTH = 64;
+
+    // "110" -> {0b110, 3}. 'code' must be at most MAX_LENGTH characters.
+    static BitCode fromString(std::string_view code) noexcept;
+};
+
+// Out-of-vocabulary words. A model whose vocabulary includes ESCAPE_WORD
+// writes a word it has no code for as the escape code followed by the word's
+// literal: the Elias-gamma code of (length + 1), then the bytes, 8 bits each.
+// Scanner tokens never contain '#', so the escape can't be a real word.
+inline constexpr std::string_view ESCAPE_WORD = "#esc";
+
+// Append 'word' as a literal through writer.putLiteralBits(). Any of the
+// .code writers works. Words must be shorter than 2^31 bytes.
+template <typename Writer>
+void putLiteral(Writer& writer, std::string_view word) {
+    const std::uint64_t n = word.size() + 1;
+    const int width = std::bit_width(n);
+    if (width > 1) {
+        writer.putLiteralBits(BitCode{0, static_cast<std::uint8_t>(width - 1)});
+    }
+    writer.putLiteralBits(BitCode{n, static_cast<std::uint8_t>(width)});
+    for (std::size_t i = 0; i < word.size(); i += 8) {
+        BitCode chunk;
+        for (std::size_t j = i; j < std::min(word.size(), i + 8); ++j) {
+            chunk.bits = (chunk.bits << 8) | static_cast<unsigned char>(word[j]);
+            chunk.length += 8;
+        }
+        writer.putLiteralBits(chunk);
+    }
+}
+
+// Packs a stream of bits into bytes (most significant bit first) and writes
+// them to an output stream. Bits collect in a 64-bit accumulator that is
+// stored 8 bytes at a time into a fixed buffer. finish() pads the last byte
+// with zeros and appends an 8-byte little-endian trailer holding the number
+// of valid bits, so a reader knows where the padding starts.
+//
+// Binary .code layout:  [packed bytes ...][uint64 valid-bit count, LE]
+class BitWriter {
+public:
+    explicit BitWriter(std::ostream& os);
+
+    // Append a single bit.
+    void putBit(bool bit);
+
+    // Append a whole code in one step.
+    void putBits(BitCode code) {
+        total_ += code.length;
+        if (code.length < 64 - used_) {
+            acc_ = (acc_ << code.length) | code.bits;
+            used_ += code.length;
+            return;
+        }
+        // The code fills the accumulator: store the full word, keep the rest
+        const int rest = used_ + code.length - 64;
+        storeWord((used_ == 0 ? 0 : acc_ << (64 - used_)) | (code.bits >> rest));
+        acc_ = rest == 0 ? 0 : code.bits & ((std::uint64_t{1} << rest) - 1);
+        used_ = rest;
+    }
+
+    // Append the bits spelled out by an ASCII '0'/'1' code string.
+    void putBits(const std::string& code);
+
+    // Bits that belong to the previous code (an escaped word's literal).
+    void putLiteralBits(BitCode code) { putBits(code); }
+
+    // Pad with zero bits up to the next byte boundary (the padding counts in bitCount()).
+    void alignToByte();
+
+    // Write out everything so far; only at a byte boundary. No trailer.
+    error_type flush();
+
+    // Write out and flush every whole byte so far, anywhere in the stream;
+    // the bits of a partial byte stay behind (streaming output).
+    error_type drain();
+
+    // Flush the partial bytes and write the trailer. Call exactly once.
+    error_type finish();
+
+    [[nodiscard]] std::uint64_t bitCount() const noexcept;
+
+    static constexpr std::size_t TRAILER_BYTES = 8;
+
+private:
+    std::ostream& os_;
+    std::vector<char> buffer_;   // fixed size; bytes [0, pos_) are pending
+    std::size_t pos_ = 0;
+    std::uint64_t acc_ = 0;      // the last used_ bits written, right-aligned
+    int used_ = 0;               // 0..63
+    std::uint64_t total_ = 0;    // bits written so far
+
+    void storeWord(std::uint64_t word) {
+        if (buffer_.size() - pos_ < 8) {
+            flushBuffer();
+        }
+        for (int i = 0; i < 8; ++i) {
+            buffer_[pos_ + i] = static_cast<char>(word >> (56 - 8 * i));
+        }
+        pos_ += 8;
+    }
+    bool flushBuffer();
+};
+
+// ASCII .code writer: one '0'/'1' character per bit, a newline after every
+// wrap_cols characters and after the last partial line. Output goes through a
+// fixed-size buffer, so memory does not grow with the message.
+class TextBitWriter {
+public:
+    explicit TextBitWriter(std::ostream& os, int wrapCols = 80);
+
+    // Append the bits spelled out by an ASCII '0'/'1' code string.
+    void putBits(const std::string& code);
+
+    // Append a code from an integer table.
+    void putBits(BitCode code);
+
+    // Bits that belong to the previous code (an escaped word's literal).
+    void putLiteralBits(BitCode code) { putBits(code); }
+
+    // End the last line and flush. Call exactly once.
+    error_type finish();
+
+    [[nodiscard]] std::uint64_t bitCount() const noexcept;
+
+private:
+    std::ostream& os_;
+    std::string buffer_;
+    int wrapCols_;
+    int lineLength_ = 0;
+    std::uint64_t total_ = 0;
+
+    bool flushBuffer();
+};
+
+// Reads bits (most significant bit first) from an in-memory byte buffer through
+// a 64-bit window, so a decoder can peek at up to 32 bits in one step.
+// Bits past the end read as zero; callers check remaining() before consuming.
+class BitReader {
+public:
+    BitReader(const unsigned char* data, std::size_t size, std::uint64_t bitCount) noexcept;
+
+    // Next n bits (1..32) as an integer without consuming them.
+    [[nodiscard]] std::uint32_t peek(int n) noexcept;
+
+    // Consume n bits (n <= 32).
+    void skip(int n) noexcept;
+
+    [[nodiscard]] std::uint64_t remaining() const noexcept;
+
+private:
+    const unsigned char* data_;
+    std::size_t size_;
+    std::size_t pos_ = 0;        // next byte to load into the window
+    std::uint64_t window_ = 0;   // valid bits are left-aligned
+    int count_ = 0;              // number of valid bits in window_
+    std::uint64_t left_;         // message bits not yet consumed
+
+    void refill() noexcept;
+};
+
+// Read one literal written by putLiteral(). Returns false if the bits run
+// out first or the length prefix is malformed.
+bool readLiteral(BitReader& reader, std::string& word);
+
+// Load a whole .code file into packed bytes.
+// ASCII: '0'/'1' characters, newlines ignored. BINARY: bytes + trailer (see BitWriter).
+// Returns CORRUPT_CODE_FILE if the contents don't match the format.
+error_type readCodeFile(std::istream& is, CodeFormat format,
+                        std::vector<unsigned char>& bytes, std::uint64_t& bitCount);
+
+#endif //BITSTREAM_H
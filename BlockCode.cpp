@@ -0,0 +1,218 @@
+#include "BlockCode.h"
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include "ThreadPool.h"
+
+namespace {
+
+constexpr char MAGIC[8] = {'H', 'U', 'F', 'B', 'L', 'K', '0', '1'};
+
+void putLittleEndian(std::ostream& os, std::uint64_t value) {
+    char bytes[8];
+    for (int i = 0; i < 8; ++i) {
+        bytes[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+    os.write(bytes, 8);
+}
+
+std::uint64_t getLittleEndian(const unsigned char* bytes) {
+    std::uint64_t value = 0;
+    for (int i = 0; i < 8; ++i) {
+        value |= static_cast<std::uint64_t>(bytes[i]) << (8 * i);
+    }
+    return value;
+}
+
+// Decode blocks first..last-1 into their slices of 'symbols' (literals appended in order)
+error_type decodeRange(const HuffmanDecoder& decoder, const unsigned char* file,
+                       const std::vector<CodeBlock>& blocks, std::size_t first, std::size_t last,
+                       std::vector<std::uint32_t>& symbols, std::vector<std::string>* literals) {
+    for (std::size_t b = first; b < last; ++b) {
+        const CodeBlock& block = blocks[b];
+        if (error_type st = decoder.decodeBlock(file + block.offset, block.size, block.tokenCount,
+                                                symbols.data() + block.firstToken, literals);
+            st != NO_ERROR) {
+            return st;
+        }
+    }
+    return NO_ERROR;
+}
+
+} // End of namespace
+
+BlockWriter::BlockWriter(std::ostream& os, std::uint64_t tokensPerBlock)
+    : os_(os), bits_(os), tokensPerBlock_(std::max<std::uint64_t>(tokensPerBlock, 1)) {}
+
+void BlockWriter::putBits(const std::string& code) {
+    if (inBlock_ == tokensPerBlock_) {
+        closeBlock();
+    }
+    bits_.putBits(code);
+    ++inBlock_;
+}
+
+// Pad the open block to a byte and record where it started
+void BlockWriter::closeBlock() {
+    bits_.alignToByte();
+    firstTokens_.push_back(tokens_);
+    offsets_.push_back(nextOffset_);
+    tokens_ += inBlock_;
+    inBlock_ = 0;
+    nextOffset_ = bits_.bitCount() / 8 + extraBytes_;
+}
+
+void BlockWriter::putBlock(const std::string& bytes, std::uint64_t tokens) {
+    if (inBlock_ > 0) {
+        closeBlock(); // the last block of putBits() codes is full
+    }
+    bits_.flush(); // keep the stream in order
+    firstTokens_.push_back(tokens_);
+    offsets_.push_back(nextOffset_);
+    os_.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    tokens_ += tokens;
+    extraBytes_ += bytes.size();
+    nextOffset_ += bytes.size();
+}
+
+error_type BlockWriter::finish() {
+    if (inBlock_ > 0) {
+        closeBlock();
+    }
+    if (error_type st = bits_.flush(); st != NO_ERROR) {
+        return st;
+    }
+
+    for (std::size_t b = 0; b < offsets_.size(); ++b) {
+        putLittleEndian(os_, firstTokens_[b]);
+        putLittleEndian(os_, offsets_[b]);
+    }
+    putLittleEndian(os_, offsets_.size());
+    putLittleEndian(os_, tokens_);
+    putLittleEndian(os_, tokensPerBlock_);
+    os_.write(MAGIC, sizeof(MAGIC));
+    return os_ ? NO_ERROR : FAILED_TO_WRITE_FILE;
+}
+
+error_type readBlockIndex(const unsigned char* file, std::size_t size,
+                          std::vector<CodeBlock>& blocks, std::uint64_t& tokenCount) {
+    blocks.clear();
+    tokenCount = 0;
+    if (size < BlockWriter::TRAILER_BYTES ||
+        std::memcmp(file + size - sizeof(MAGIC), MAGIC, sizeof(MAGIC)) != 0) {
+        return CORRUPT_CODE_FILE;
+    }
+    const unsigned char* trailer = file + size - BlockWriter::TRAILER_BYTES;
+    const std::uint64_t count = getLittleEndian(trailer);
+    const std::uint64_t tokensPerBlock = getLittleEndian(trailer + 16);
+    tokenCount = getLittleEndian(trailer + 8);
+    if (count > (size - BlockWriter::TRAILER_BYTES) / BlockWriter::INDEX_ENTRY_BYTES) {
+        return CORRUPT_CODE_FILE;
+    }
+
+    // Blocks run from their offset to the next block (the last one to the index).
+    // Every code is at least one bit, so no count may exceed the bits holding it:
+    // callers size their symbol buffers from these before decoding anything
+    const std::size_t indexStart = size - BlockWriter::TRAILER_BYTES - count * BlockWriter::INDEX_ENTRY_BYTES;
+    const bool totalOk = tokensPerBlock > 0 && tokenCount <= 8 * static_cast<std::uint64_t>(indexStart) &&
+                         (tokenCount / tokensPerBlock < count ||
+                          (tokenCount / tokensPerBlock == count && tokenCount % tokensPerBlock == 0));
+    if (!totalOk) {
+        return CORRUPT_CODE_FILE;
+    }
+    blocks.resize(count);
+    for (std::size_t b = 0; b < count; ++b) {
+        const unsigned char* entry = file + indexStart + b * BlockWriter::INDEX_ENTRY_BYTES;
+        blocks[b].firstToken = getLittleEndian(entry);
+        blocks[b].offset = getLittleEndian(entry + 8);
+    }
+    for (std::size_t b = 0; b < count; ++b) {
+        const std::uint64_t nextToken = b + 1 < count ? blocks[b + 1].firstToken : tokenCount;
+        const std::size_t nextOffset = b + 1 < count ? blocks[b + 1].offset : indexStart;
+        const bool firstOk = b > 0 || (blocks[b].firstToken == 0 && blocks[b].offset == 0);
+        if (!firstOk || nextToken <= blocks[b].firstToken || nextOffset < blocks[b].offset) {
+            blocks.clear();
+            return CORRUPT_CODE_FILE;
+        }
+        blocks[b].tokenCount = nextToken - blocks[b].firstToken;
+        blocks[b].size = nextOffset - blocks[b].offset;
+        if (blocks[b].tokenCount > tokensPerBlock ||
+            blocks[b].tokenCount > 8 * static_cast<std::uint64_t>(blocks[b].size)) {
+            blocks.clear();
+            return CORRUPT_CODE_FILE;
+        }
+    }
+    if (count == 0 && (tokenCount != 0 || indexStart != 0)) {
+        return CORRUPT_CODE_FILE;
+    }
+    return NO_ERROR;
+}
+
+error_type decodeBlocks(const HuffmanDecoder& decoder, const unsigned char* file,
+                        const std::vector<CodeBlock>& blocks, std::uint64_t tokenCount,
+                        std::vector<std::uint32_t>& symbols, std::vector<std::string>* literals) {
+    symbols.resize(tokenCount);
+    if (literals != nullptr) {
+        literals->clear();
+    }
+    return decodeRange(decoder, file, blocks, 0, blocks.size(), symbols, literals);
+}
+
+// Blocks are independent: hand them out to the pool a few at a time
+error_type decodeBlocks(const HuffmanDecoder& decoder, const unsigned char* file,
+                        const std::vector<CodeBlock>& blocks, std::uint64_t tokenCount,
+                        std::vector<std::uint32_t>& symbols, ThreadPool& pool,
+                        std::vector<std::string>* literals) {
+    symbols.resize(tokenCount);
+    if (literals != nullptr) {
+        literals->clear();
+    }
+    const std::size_t groups = std::min<std::size_t>(blocks.size(), 4 * pool.size());
+    if (groups <= 1) {
+        return decodeRange(decoder, file, blocks, 0, blocks.size(), symbols, literals);
+    }
+    // Each group collects its own literals; joined in group order afterwards
+    std::vector<error_type> status(groups, NO_ERROR);
+    std::vector<std::vector<std::string>> groupLiterals(literals != nullptr ? groups : 0);
+    pool.parallelFor(groups, [&](std::size_t g) {
+        status[g] = decodeRange(decoder, file, blocks, g * blocks.size() / groups,
+                                (g + 1) * blocks.size() / groups, symbols,
+                                literals != nullptr ? &groupLiterals[g] : nullptr);
+    });
+    for (error_type st : status) {
+        if (st != NO_ERROR) {
+            return st;
+        }
+    }
+    for (auto& group : groupLiterals) {
+        std::ranges::move(group, std::back_inserter(*literals));
+    }
+    return NO_ERROR;
+}
+
+error_type decodeToken(const HuffmanDecoder& decoder, const unsigned char* file,
+                       const std::vector<CodeBlock>& blocks, std::uint64_t token,
+                       std::uint32_t& symbol, std::string* literal) {
+    // Last block whose first token is <= 'token'
+    const auto it = std::ranges::upper_bound(blocks, token, {}, &CodeBlock::firstToken);
+    if (it == blocks.begin() || token >= std::prev(it)->firstToken + std::prev(it)->tokenCount) {
+        return CORRUPT_CODE_FILE;
+    }
+    const CodeBlock& block = *std::prev(it);
+    std::vector<std::uint32_t> symbols(block.tokenCount);
+    std::vector<std::string> literals;
+    if (error_type st = decoder.decodeBlock(file + block.offset, block.size, block.tokenCount, symbols.data(),
+                                            &literals);
+        st != NO_ERROR) {
+        return st;
+    }
+    const std::size_t index = token - block.firstToken;
+    symbol = symbols[index];
+    if (literal != nullptr && decoder.isEscape(symbol)) {
+        // The token's literal comes after those of the escapes before it in the block
+        const auto before = std::count_if(symbols.begin(), symbols.begin() + static_cast<std::ptrdiff_t>(index),
+                                          [&decoder](std::uint32_t s) { return decoder.isEscape(s); });
+        *literal = literals[static_cast<std::size_t>(before)];
+    }
+    return NO_ERROR;
+}
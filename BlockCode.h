@@ -0,0 +1,104 @@
+#ifndef BLOCKCODE_H
+#define BLOCKCODE_H
+
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "BitStream.h"
+#include "HuffmanDecoder.h"
+#include "utils.hpp"
+
+class ThreadPool;
+
+// Blocked .code container (CodeFormat::BLOCKED). Tokens are grouped into
+// blocks of a fixed number of tokens; each block's codes start on a byte
+// boundary and end with zero padding, so a block decodes without the ones
+// before it. The footer index says where every block starts.
+//
+//   [block 0][block 1] ... [block n-1]
+//   [index: n x (uint64 first token, uint64 byte offset)]
+//   [trailer: uint64 n, uint64 total tokens, uint64 tokens per block, "HUFBLK01"]
+//
+// All integers are little-endian. Byte offsets count from the start of the file.
+
+// One block as described by the index.
+struct CodeBlock {
+    std::uint64_t firstToken = 0;
+    std::uint64_t tokenCount = 0;
+    std::size_t offset = 0; // first byte of the block in the file
+    std::size_t size = 0;   // bytes, padding included
+};
+
+// Writes the container one code (= one token) at a time, closing a block
+// every tokensPerBlock codes. Has the same putBits()/finish() interface as
+// BitWriter, so any encoder that drives one can drive this.
+class BlockWriter {
+public:
+    static constexpr std::uint64_t DEFAULT_BLOCK_TOKENS = 1 << 16;
+    static constexpr std::size_t INDEX_ENTRY_BYTES = 16;
+    static constexpr std::size_t TRAILER_BYTES = 32;
+
+    explicit BlockWriter(std::ostream& os, std::uint64_t tokensPerBlock = DEFAULT_BLOCK_TOKENS);
+
+    // Append one token's code. A full block is closed when the next token
+    // arrives, so literal bits after the block's last code stay in that block.
+    void putBits(BitCode code) {
+        if (inBlock_ == tokensPerBlock_) {
+            closeBlock();
+        }
+        bits_.putBits(code);
+        ++inBlock_;
+    }
+    void putBits(const std::string& code);
+
+    // Bits that belong to the previous code (an escaped word's literal); not a token.
+    void putLiteralBits(BitCode code) { bits_.putBits(code); }
+
+    // Append a whole block packed elsewhere (e.g. on another thread): 'bytes'
+    // holds 'tokens' codes padded to a byte. Only between blocks, i.e. after a
+    // multiple of tokensPerBlock codes.
+    void putBlock(const std::string& bytes, std::uint64_t tokens);
+
+    // Close the last block, then write the index and trailer. Call exactly once.
+    error_type finish();
+
+    [[nodiscard]] std::uint64_t tokensPerBlock() const noexcept { return tokensPerBlock_; }
+
+private:
+    std::ostream& os_;
+    BitWriter bits_;
+    std::uint64_t tokensPerBlock_;
+    std::uint64_t inBlock_ = 0;    // codes in the open block
+    std::uint64_t tokens_ = 0;     // codes in closed blocks
+    std::uint64_t extraBytes_ = 0; // bytes that went through putBlock()
+    std::uint64_t nextOffset_ = 0; // where the open block starts
+    std::vector<std::uint64_t> firstTokens_;
+    std::vector<std::uint64_t> offsets_;
+
+    void closeBlock();
+};
+
+// Parse the footer of a blocked .code file held in file[0..size).
+// Returns CORRUPT_CODE_FILE if the trailer or index is inconsistent.
+error_type readBlockIndex(const unsigned char* file, std::size_t size,
+                          std::vector<CodeBlock>& blocks, std::uint64_t& tokenCount);
+
+// Decode every block into 'symbols' (resized to the token count), serially or on 'pool'.
+// Escaped words' literals go to 'literals' in token order, if given.
+error_type decodeBlocks(const HuffmanDecoder& decoder, const unsigned char* file,
+                        const std::vector<CodeBlock>& blocks, std::uint64_t tokenCount,
+                        std::vector<std::uint32_t>& symbols, std::vector<std::string>* literals = nullptr);
+error_type decodeBlocks(const HuffmanDecoder& decoder, const unsigned char* file,
+                        const std::vector<CodeBlock>& blocks, std::uint64_t tokenCount,
+                        std::vector<std::uint32_t>& symbols, ThreadPool& pool,
+                        std::vector<std::string>* literals = nullptr);
+
+// Random access: decode only the block holding token number 'token'. If the
+// token is an escaped word and 'literal' is given, it receives the spelling.
+error_type decodeToken(const HuffmanDecoder& decoder, const unsigned char* file,
+                       const std::vector<CodeBlock>& blocks, std::uint64_t token,
+                       std::uint32_t& symbol, std::string* literal = nullptr);
+
+#endif //BLOCKCODE_H
@@ -0,0 +1,337 @@
+#include "FlatHuffmanTree.h"
+#include <algorithm>
+#include <tuple>
+
+// Direct two-queue build into index arrays (see HuffmanTree::buildUnbounded)
+FlatHuffmanTree FlatHuffmanTree::buildFromSymbolCounts(const std::vector<int>& freqs,
+                                                       const std::vector<std::string_view>& words,
+                                                       const HuffmanBuildOptions& options) {
+    if (options.maxCodeLength > 0) {
+        return fromTree(HuffmanTree::buildFromSymbolCounts(freqs, words, options));
+    }
+
+    FlatHuffmanTree tree;
+    const std::size_t n = freqs.size();
+    if (n == 0) {
+        return tree;
+    }
+    tree.words_.assign(words.begin(), words.end());
+
+    // Nodes 0..n-1 are the leaves (node = symbol), merged nodes follow
+    const std::size_t total = 2 * n - 1;
+    tree.children_.assign(2 * total, -1);
+    tree.freq_.assign(total, 0);
+    tree.symbol_.assign(total, -1);
+    std::vector<std::int32_t> rank(total);
+    for (std::size_t i = 0; i < n; ++i) {
+        tree.freq_[i] = static_cast<std::uint64_t>(freqs[i]);
+        tree.symbol_[i] = static_cast<std::int32_t>(i);
+        rank[i] = static_cast<std::int32_t>(i);
+    }
+
+    // Same order as PriorityQueue::higherPriority: freq asc, then rank desc
+    auto higherPriority = [&](std::int32_t a, std::int32_t b) {
+        if (tree.freq_[a] != tree.freq_[b]) return tree.freq_[a] < tree.freq_[b];
+        return rank[a] > rank[b];
+    };
+    std::vector<std::int32_t> leaves(n);
+    for (std::size_t i = 0; i < n; ++i) leaves[i] = static_cast<std::int32_t>(i);
+    std::ranges::sort(leaves, higherPriority);
+
+    // Merged nodes are created in extraction order, so they form the second queue as-is
+    std::size_t leafHead = 0;
+    auto next = static_cast<std::int32_t>(n);
+    std::int32_t mergedHead = next;
+    auto takeMin = [&]() {
+        if (mergedHead == next || (leafHead < n && higherPriority(leaves[leafHead], mergedHead))) {
+            return leaves[leafHead++];
+        }
+        return mergedHead++;
+    };
+    for (std::size_t remaining = n; remaining > 1; --remaining) {
+        const std::int32_t a = takeMin();
+        const std::int32_t b = takeMin();
+        tree.children_[2 * next] = a;     // first extracted goes left
+        tree.children_[2 * next + 1] = b; // second extracted goes right
+        tree.freq_[next] = tree.freq_[a] + tree.freq_[b];
+        rank[next] = std::min(rank[a], rank[b]);
+        ++next;
+    }
+
+    tree.relayout(n == 1 ? 0 : next - 1);
+    return tree;
+}
+
+// Pre-order copy of a pointer tree
+FlatHuffmanTree FlatHuffmanTree::fromTree(const HuffmanTree& source) {
+    FlatHuffmanTree tree;
+    tree.canonical_ = source.canonical_;
+    if (source.root_ == nullptr) {
+        return tree;
+    }
+
+    // (node, parent index, which child of the parent)
+    std::vector<std::tuple<const TreeNode*, std::int32_t, int>> stack{{source.root_, -1, 0}};
+    while (!stack.empty()) {
+        const auto [node, parent, side] = stack.back();
+        stack.pop_back();
+
+        const auto index = static_cast<std::int32_t>(tree.freq_.size());
+        tree.children_.push_back(-1);
+        tree.children_.push_back(-1);
+        tree.freq_.push_back(static_cast<std::uint64_t>(node->freq));
+        tree.symbol_.push_back(-1);
+        if (parent >= 0) {
+            tree.children_[2 * parent + side] = index;
+        }
+
+        if (node->left == nullptr && node->right == nullptr) {
+            const auto symbol = static_cast<std::size_t>(node->rank);
+            if (tree.words_.size() <= symbol) {
+                tree.words_.resize(symbol + 1);
+            }
+            tree.words_[symbol] = node->key_word;
+            tree.symbol_[index] = node->rank;
+            continue;
+        }
+        if (node->right != nullptr) stack.emplace_back(node->right, index, 1);
+        if (node->left != nullptr) stack.emplace_back(node->left, index, 0);
+    }
+    return tree;
+}
+
+template <typename Visit>
+void FlatHuffmanTree::forEachLeaf(Visit&& visit) const {
+    if (freq_.empty()) {
+        return;
+    }
+    // A node's code is its parent's code plus one bit. The stack pops a right
+    // child only after the whole left subtree, which never touched the
+    // positions above the right child's depth, so one prefix string suffices.
+    std::string prefix;
+    std::vector<std::tuple<std::int32_t, int, char>> stack{{0, 0, '0'}};
+    while (!stack.empty()) {
+        const auto [node, depth, bit] = stack.back();
+        stack.pop_back();
+        if (depth > 0) {
+            prefix.resize(static_cast<std::size_t>(depth - 1));
+            prefix.push_back(bit);
+        }
+        if (isLeaf(node)) {
+            visit(node, depth, prefix);
+            continue;
+        }
+        stack.emplace_back(children_[2 * node + 1], depth + 1, '1');
+        stack.emplace_back(children_[2 * node], depth + 1, '0');
+    }
+}
+
+void FlatHuffmanTree::assignCodes(std::vector<std::pair<std::string,std::string>>& out) const {
+    out.clear();
+    forEachLeaf([&](std::int32_t leaf, int, const std::string& code) {
+        out.emplace_back(words_[symbol_[leaf]], code.empty() ? "0" : code); // single-word edge case
+    });
+}
+
+void FlatHuffmanTree::codeTable(std::vector<std::string>& codes) const {
+    codes.assign(words_.size(), std::string());
+    forEachLeaf([&](std::int32_t leaf, int, const std::string& code) {
+        codes[symbol_[leaf]] = code.empty() ? "0" : code;
+    });
+}
+
+bool FlatHuffmanTree::codeTable(std::vector<BitCode>& codes) const {
+    codes.assign(words_.size(), BitCode{});
+    bool fits = true;
+    forEachLeaf([&](std::int32_t leaf, int depth, const std::string& code) {
+        if (depth > BitCode::MAX_LENGTH) {
+            fits = false;
+            return;
+        }
+        codes[symbol_[leaf]] = depth == 0 ? BitCode{0, 1} : BitCode::fromString(code);
+    });
+    return fits;
+}
+
+int FlatHuffmanTree::maxCodeLength() const {
+    if (freq_.empty()) {
+        return 0;
+    }
+    int longest = 1;
+    forEachLeaf([&](std::int32_t, int depth, const std::string&) {
+        longest = std::max(longest, depth);
+    });
+    return longest;
+}
+
+std::uint64_t FlatHuffmanTree::encodedBits() const {
+    std::uint64_t bits = 0;
+    forEachLeaf([&](std::int32_t leaf, int depth, const std::string&) {
+        bits += freq_[leaf] * static_cast<std::uint64_t>(std::max(depth, 1));
+    });
+    return bits;
+}
+
+void FlatHuffmanTree::makeCanonical() {
+    canonical_ = true;
+
+    // A single word has no internal nodes; its code "0" is already canonical
+    if (freq_.size() <= 1) {
+        return;
+    }
+    std::vector<int> lengthOf(words_.size(), 0);
+    forEachLeaf([&](std::int32_t leaf, int depth, const std::string&) {
+        lengthOf[symbol_[leaf]] = depth;
+    });
+    buildCanonicalShape(lengthOf);
+}
+
+// Same bytes as HuffmanTree::writeHeader, written straight from the walk
+error_type FlatHuffmanTree::writeHeader(std::ostream& os) const {
+    if (freq_.empty()) {
+        return NO_ERROR;
+    }
+    if (!canonical_) {
+        forEachLeaf([&](std::int32_t leaf, int, const std::string& code) {
+            os << words_[symbol_[leaf]] << ' ' << (code.empty() ? "0" : code) << '\n';
+        });
+        return os ? NO_ERROR : FAILED_TO_WRITE_FILE;
+    }
+
+    // Canonical: counts per code length first, then the words in code order
+    std::vector<std::size_t> perLength;
+    forEachLeaf([&](std::int32_t, int depth, const std::string&) {
+        const auto length = static_cast<std::size_t>(std::max(depth, 1));
+        if (perLength.size() < length) {
+            perLength.resize(length, 0);
+        }
+        perLength[length - 1]++;
+    });
+    os << "#canonical\n";
+    for (std::size_t i = 0; i < perLength.size(); ++i) {
+        os << (i == 0 ? "" : " ") << perLength[i];
+    }
+    os << '\n';
+    forEachLeaf([&](std::int32_t leaf, int, const std::string&) {
+        os << words_[symbol_[leaf]] << '\n';
+    });
+    return os ? NO_ERROR : FAILED_TO_WRITE_FILE;
+}
+
+error_type FlatHuffmanTree::encode(const std::vector<std::uint32_t>& symbols,
+                                   std::ostream& os_bits,
+                                   CodeFormat format,
+                                   int wrap_cols) const {
+    std::vector<BitCode> codes;
+    if (codeTable(codes)) {
+        return HuffmanTree::encodeWithTable(codes, symbols, os_bits, format, wrap_cols);
+    }
+    std::vector<std::string> longCodes;
+    codeTable(longCodes);
+    return HuffmanTree::encodeWithTable(longCodes, symbols, os_bits, format, wrap_cols);
+}
+
+error_type FlatHuffmanTree::encode(const std::vector<std::uint32_t>& symbols,
+                                   std::ostream& os_bits,
+                                   CodeFormat format,
+                                   ThreadPool& pool,
+                                   int wrap_cols) const {
+    std::vector<BitCode> codes;
+    if (codeTable(codes)) {
+        return HuffmanTree::encodeWithTable(codes, symbols, os_bits, format, pool, wrap_cols);
+    }
+    return encode(symbols, os_bits, format, wrap_cols);
+}
+
+// Helper: renumber the nodes reachable from 'root' into pre-order (root = 0)
+void FlatHuffmanTree::relayout(std::int32_t root) {
+    std::vector<std::int32_t> order;
+    order.reserve(freq_.size());
+    std::vector<std::int32_t> stack{root};
+    while (!stack.empty()) {
+        const std::int32_t node = stack.back();
+        stack.pop_back();
+        order.push_back(node);
+        if (!isLeaf(node)) {
+            stack.push_back(children_[2 * node + 1]);
+            stack.push_back(children_[2 * node]);
+        }
+    }
+
+    std::vector<std::int32_t> newIndex(freq_.size(), -1);
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        newIndex[order[i]] = static_cast<std::int32_t>(i);
+    }
+    std::vector<std::int32_t> children(2 * order.size(), -1);
+    std::vector<std::uint64_t> freq(order.size());
+    std::vector<std::int32_t> symbol(order.size());
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        const std::int32_t old = order[i];
+        if (!isLeaf(old)) {
+            children[2 * i] = newIndex[children_[2 * old]];
+            children[2 * i + 1] = newIndex[children_[2 * old + 1]];
+        }
+        freq[i] = freq_[old];
+        symbol[i] = symbol_[old];
+    }
+    children_ = std::move(children);
+    freq_ = std::move(freq);
+    symbol_ = std::move(symbol);
+}
+
+// Helper: the canonical tree for the given code lengths (see HuffmanTree::buildCanonicalShape)
+void FlatHuffmanTree::buildCanonicalShape(const std::vector<int>& lengthOf) {
+    std::vector<std::uint64_t> freqOf(words_.size(), 0);
+    for (std::size_t i = 0; i < freq_.size(); ++i) {
+        if (symbol_[i] >= 0) freqOf[symbol_[i]] = freq_[i];
+    }
+
+    // Canonical order: shorter codes first, words alphabetical within a length
+    std::vector<std::int32_t> order;
+    for (std::size_t s = 0; s < lengthOf.size(); ++s) {
+        if (lengthOf[s] > 0) order.push_back(static_cast<std::int32_t>(s));
+    }
+    std::ranges::sort(order, [&](std::int32_t a, std::int32_t b) {
+        if (lengthOf[a] != lengthOf[b]) return lengthOf[a] < lengthOf[b];
+        return words_[a] < words_[b];
+    });
+
+    children_.assign(2, -1);
+    freq_.assign(1, 0);
+    symbol_.assign(1, -1);
+    auto newNode = [&](std::int32_t symbol, std::uint64_t freq) {
+        children_.push_back(-1);
+        children_.push_back(-1);
+        freq_.push_back(freq);
+        symbol_.push_back(symbol);
+        return static_cast<std::int32_t>(freq_.size() - 1);
+    };
+
+    // Hand out codes by counting up, shifting left whenever the length grows,
+    // and hang each leaf at the end of its code's path
+    std::uint64_t code = 0;
+    int prevLength = lengthOf[order.front()];
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        const std::int32_t s = order[i];
+        const int length = lengthOf[s];
+        if (i > 0) {
+            code = (code + 1) << (length - prevLength);
+        }
+        prevLength = length;
+
+        std::int32_t node = 0;
+        freq_[node] += freqOf[s];
+        for (int d = length - 1; d > 0; --d) {
+            const std::size_t slot = 2 * static_cast<std::size_t>(node) + ((code >> d) & 1);
+            if (children_[slot] < 0) {
+                const std::int32_t child = newNode(-1, 0);
+                children_[slot] = child;
+            }
+            node = children_[slot];
+            freq_[node] += freqOf[s];
+        }
+        const std::int32_t leaf = newNode(s, freqOf[s]);
+        children_[2 * static_cast<std::size_t>(node) + (code & 1)] = leaf;
+    }
+    relayout(0);
+}
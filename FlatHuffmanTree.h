@@ -0,0 +1,80 @@
+#ifndef FLATHUFFMANTREE_H
+#define FLATHUFFMANTREE_H
+
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility> // std::pair
+#include <vector>
+#include "HuffmanTree.h"
+
+// Where a Huffman tree's nodes live.
+//   POINTER - HuffmanTree: TreeNodes linked by pointers, a string in every node
+//   FLAT    - FlatHuffmanTree: parallel arrays indexed by node number
+enum class TreeLayout { POINTER, FLAT };
+
+// The same Huffman tree as HuffmanTree, stored in contiguous arrays:
+//   children_[2i], children_[2i + 1]  left/right child of node i (-1 at a leaf)
+//   freq_[i]                          weight of node i
+//   symbol_[i]                        leaf i's symbol, -1 for internal nodes
+//   words_[s]                         the word of symbol s (leaves only)
+// Nodes are stored in pre-order with the root at 0, so a code-assignment walk
+// reads the arrays front to back, and internal nodes hold no strings at all.
+// Every traversal is a loop with an explicit stack.
+class FlatHuffmanTree {
+public:
+    // Same tree (same codes) as HuffmanTree::buildFromSymbolCounts: the
+    // unbounded case is merged directly into index arrays with the same
+    // two-queue order and tie-breaks; a length limit goes through package-merge
+    // in HuffmanTree and the result is flattened.
+    static FlatHuffmanTree buildFromSymbolCounts(const std::vector<int>& freqs,
+                                                 const std::vector<std::string_view>& words,
+                                                 const HuffmanBuildOptions& options = {});
+
+    // Copy any pointer tree's shape (leaf ranks become symbols).
+    static FlatHuffmanTree fromTree(const HuffmanTree& tree);
+
+    // Same meaning and output as the HuffmanTree members of the same name.
+    void assignCodes(std::vector<std::pair<std::string,std::string>>& out) const;
+    void codeTable(std::vector<std::string>& codes) const;
+    [[nodiscard]] bool codeTable(std::vector<BitCode>& codes) const;
+    [[nodiscard]] int maxCodeLength() const;
+    [[nodiscard]] std::uint64_t encodedBits() const;
+    void makeCanonical();
+    [[nodiscard]] bool isCanonical() const noexcept { return canonical_; }
+    error_type writeHeader(std::ostream& os) const;
+    error_type encode(const std::vector<std::uint32_t>& symbols,
+                      std::ostream& os_bits,
+                      CodeFormat format,
+                      int wrap_cols = 80) const;
+    error_type encode(const std::vector<std::uint32_t>& symbols,
+                      std::ostream& os_bits,
+                      CodeFormat format,
+                      ThreadPool& pool,
+                      int wrap_cols = 80) const;
+
+    [[nodiscard]] std::size_t nodeCount() const noexcept { return freq_.size(); }
+
+private:
+    std::vector<std::int32_t> children_;
+    std::vector<std::uint64_t> freq_;
+    std::vector<std::int32_t> symbol_;
+    std::vector<std::string> words_;
+    bool canonical_ = false;
+
+    [[nodiscard]] bool isLeaf(std::int32_t node) const noexcept { return children_[2 * node] < 0; }
+
+    // Visit every leaf in pre-order as visit(leaf, depth, code so far)
+    template <typename Visit>
+    void forEachLeaf(Visit&& visit) const;
+
+    // Renumber the nodes into pre-order from 'root'
+    void relayout(std::int32_t root);
+
+    // Replace the shape with the canonical tree for per-symbol code lengths
+    void buildCanonicalShape(const std::vector<int>& lengthOf);
+};
+
+#endif //FLATHUFFMANTREE_H
@@ -0,0 +1,125 @@
+#include "FrequencyCounter.h"
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Hash.h"
+
+namespace {
+constexpr std::size_t INITIAL_SLOTS = 1024;
+}
+
+// ================================
+// FrequencyCounter
+// ================================
+
+std::unique_ptr<FrequencyCounter> FrequencyCounter::create(CounterKind kind) {
+    if (kind == CounterKind::HASH) {
+        return std::make_unique<HashCounter>();
+    }
+    return std::make_unique<BstCounter>();
+}
+
+void FrequencyCounter::bulkAdd(const std::vector<std::string>& words) {
+    for (const std::string& word : words) {
+        add(word);
+    }
+}
+
+
+
+// ================================
+// BstCounter
+// ================================
+
+void BstCounter::add(std::string_view word) {
+    tree_.insert(word);
+}
+
+void BstCounter::collect(std::vector<std::pair<std::string,int>>& out) const {
+    tree_.inorderCollect(out);
+}
+
+std::size_t BstCounter::distinct() const noexcept {
+    return tree_.size();
+}
+
+void BstCounter::printStats(std::ostream& os) const {
+    os << "BST height: " << tree_.height() << "\n";
+    os << "BST unique words: " << tree_.size() << "\n";
+}
+
+
+
+// ================================
+// HashCounter
+// ================================
+
+HashCounter::HashCounter() : slots_(INITIAL_SLOTS) {}
+
+void HashCounter::add(std::string_view word) {
+    const std::uint64_t hash = hashBytes(word);
+    const std::size_t mask = slots_.size() - 1;
+
+    for (std::size_t i = hash & mask; ; i = (i + 1) & mask) {
+        Slot& slot = slots_[i];
+        if (slot.key.empty()) {
+            // New word: copy it into the arena and claim the slot
+            slot.hash = hash;
+            slot.key = arena_.store(word);
+            slot.count = 1;
+            // Keep the load factor at or below 1/2 so probe runs stay short
+            if (++used_ * 2 > slots_.size()) {
+                grow();
+            }
+            return;
+        }
+        if (slot.hash == hash && slot.key == word) {
+            slot.count++;
+            return;
+        }
+    }
+}
+
+// Double the table, re-placing slots by their cached hashes
+void HashCounter::grow() {
+    std::vector<Slot> old(slots_.size() * 2);
+    old.swap(slots_);
+    const std::size_t mask = slots_.size() - 1;
+    for (const Slot& slot : old) {
+        if (slot.key.empty()) {
+            continue;
+        }
+        std::size_t i = slot.hash & mask;
+        while (!slots_[i].key.empty()) {
+            i = (i + 1) & mask;
+        }
+        slots_[i] = slot;
+    }
+}
+
+void HashCounter::collect(std::vector<std::pair<std::string,int>>& out) const {
+    std::vector<const Slot*> filled;
+    filled.reserve(used_);
+    for (const Slot& slot : slots_) {
+        if (!slot.key.empty()) {
+            filled.push_back(&slot);
+        }
+    }
+    std::ranges::sort(filled, [](const Slot* a, const Slot* b) { return a->key < b->key; });
+
+    out.reserve(out.size() + filled.size());
+    for (const Slot* slot : filled) {
+        out.emplace_back(std::string(slot->key), slot->count);
+    }
+}
+
+std::size_t HashCounter::distinct() const noexcept {
+    return used_;
+}
+
+void HashCounter::printStats(std::ostream& os) const {
+    os << "Hash unique words: " << used_ << "\n";
+    os << "Hash table slots: " << slots_.size() << " (load "
+       << static_cast<double>(used_) / static_cast<double>(slots_.size()) << ")\n";
+}
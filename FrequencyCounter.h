@@ -0,0 +1,80 @@
+#ifndef FREQUENCYCOUNTER_H
+#define FREQUENCYCOUNTER_H
+
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility> // std::pair
+#include <vector>
+#include "BinSearchTree.h"
+#include "StringArena.h"
+
+// Which data structure counts word frequencies.
+//   BST  - AVL-balanced BinSearchTree (one node per distinct word)
+//   HASH - open-addressing hash table over arena-stored keys
+enum class CounterKind { BST, HASH };
+
+// Counts how often each word occurs. Every backend hands the next stage the
+// same thing BinSearchTree::inorderCollect does: (word, count) in lexicographic order.
+class FrequencyCounter {
+public:
+    virtual ~FrequencyCounter() = default;
+
+    static std::unique_ptr<FrequencyCounter> create(CounterKind kind);
+
+    virtual void add(std::string_view word) = 0;
+    void bulkAdd(const std::vector<std::string>& words);
+
+    // (word, count) pairs in lexicographic word order
+    virtual void collect(std::vector<std::pair<std::string,int>>& out) const = 0;
+
+    [[nodiscard]] virtual std::size_t distinct() const noexcept = 0;
+
+    // Backend-specific metrics, one "name: value" per line
+    virtual void printStats(std::ostream& os) const = 0;
+};
+
+// BinSearchTree behind the counter interface. AVL-balanced, so token order
+// (sorted, shuffled, ...) no longer matters for the cost of counting.
+class BstCounter : public FrequencyCounter {
+public:
+    void add(std::string_view word) override;
+    void collect(std::vector<std::pair<std::string,int>>& out) const override;
+    [[nodiscard]] std::size_t distinct() const noexcept override;
+    void printStats(std::ostream& os) const override;
+
+private:
+    BinSearchTree tree_{TreeBalance::AVL};
+};
+
+// Open addressing with linear probing. Slots are flat (no per-word heap
+// node), each caches its key's full hash so probes compare hashes before
+// bytes and the table can grow without rehashing strings, and keys are
+// string_views into a StringArena that never moves them.
+class HashCounter : public FrequencyCounter {
+public:
+    HashCounter();
+
+    void add(std::string_view word) override;
+    void collect(std::vector<std::pair<std::string,int>>& out) const override;
+    [[nodiscard]] std::size_t distinct() const noexcept override;
+    void printStats(std::ostream& os) const override;
+
+private:
+    struct Slot {
+        std::uint64_t hash = 0;
+        std::string_view key;   // empty key = free slot (words are never empty)
+        int count = 0;
+    };
+
+    std::vector<Slot> slots_;   // size is a power of two
+    std::size_t used_ = 0;
+    StringArena arena_;
+
+    void grow();
+};
+
+#endif //FREQUENCYCOUNTER_H
@@ -0,0 +1,111 @@
+#include "Hash.h"
+#include <bit>
+#include <cstring>
+
+namespace {
+
+constexpr std::uint64_t K1 = 0x9E3779B97F4A7C15ull;
+constexpr std::uint64_t K2 = 0xBF58476D1CE4E5B9ull;
+constexpr std::uint64_t K3 = 0x94D049BB133111EBull;
+
+// splitmix64 finalizer: every input bit affects every output bit
+inline std::uint64_t avalanche(std::uint64_t x) noexcept {
+    x ^= x >> 30;
+    x *= K2;
+    x ^= x >> 27;
+    x *= K3;
+    x ^= x >> 31;
+    return x;
+}
+
+inline std::uint64_t load64(const char* p) noexcept {
+    std::uint64_t v;
+    std::memcpy(&v, p, sizeof v);
+    return v;
+}
+
+inline std::uint32_t load32(const char* p) noexcept {
+    std::uint32_t v;
+    std::memcpy(&v, p, sizeof v);
+    return v;
+}
+
+// XXH64 primes and lane round
+constexpr std::uint64_t P1 = 0x9E3779B185EBCA87ull;
+constexpr std::uint64_t P2 = 0xC2B2AE3D27D4EB4Full;
+constexpr std::uint64_t P3 = 0x165667B19E3779F9ull;
+constexpr std::uint64_t P4 = 0x85EBCA77C2B2AE63ull;
+constexpr std::uint64_t P5 = 0x27D4EB2F165667C5ull;
+
+inline std::uint64_t xxRound(std::uint64_t acc, std::uint64_t input) noexcept {
+    return std::rotl(acc + input * P2, 31) * P1;
+}
+
+inline std::uint64_t xxMerge(std::uint64_t acc, std::uint64_t lane) noexcept {
+    return (acc ^ xxRound(0, lane)) * P1 + P4;
+}
+
+} // End of namespace
+
+std::uint64_t hashBytes(std::string_view bytes) noexcept {
+    const char* p = bytes.data();
+    std::size_t n = bytes.size();
+    std::uint64_t h = K1 ^ (static_cast<std::uint64_t>(n) * K2);
+
+    for (; n >= 8; p += 8, n -= 8) {
+        h = (h ^ load64(p)) * K3;
+        h ^= h >> 29;
+    }
+    if (n > 0) {
+        std::uint64_t tail = 0;
+        std::memcpy(&tail, p, n);
+        h = (h ^ tail) * K3;
+    }
+    return avalanche(h);
+}
+
+// Reference algorithm; reads are little-endian, as on every platform we build for
+std::uint64_t xxHash64(std::string_view bytes, std::uint64_t seed) noexcept {
+    const char* p = bytes.data();
+    const char* const end = p + bytes.size();
+    std::uint64_t h;
+
+    if (bytes.size() >= 32) {
+        std::uint64_t v1 = seed + P1 + P2;
+        std::uint64_t v2 = seed + P2;
+        std::uint64_t v3 = seed;
+        std::uint64_t v4 = seed - P1;
+        for (; end - p >= 32; p += 32) {
+            v1 = xxRound(v1, load64(p));
+            v2 = xxRound(v2, load64(p + 8));
+            v3 = xxRound(v3, load64(p + 16));
+            v4 = xxRound(v4, load64(p + 24));
+        }
+        h = std::rotl(v1, 1) + std::rotl(v2, 7) + std::rotl(v3, 12) + std::rotl(v4, 18);
+        h = xxMerge(h, v1);
+        h = xxMerge(h, v2);
+        h = xxMerge(h, v3);
+        h = xxMerge(h, v4);
+    } else {
+        h = seed + P5;
+    }
+    h += bytes.size();
+
+    for (; end - p >= 8; p += 8) {
+        h = std::rotl(h ^ xxRound(0, load64(p)), 27) * P1 + P4;
+    }
+    if (end - p >= 4) {
+        h = std::rotl(h ^ (load32(p) * P1), 23) * P2 + P3;
+        p += 4;
+    }
+    for (; p < end; ++p) {
+        h = std::rotl(h ^ (static_cast<unsigned char>(*p) * P5), 11) * P1;
+    }
+
+    h ^= h >> 33;
+    h *= P2;
+    h ^= h >> 29;
+    h *= P3;
+    h ^= h >> 32;
+    return h;
+}
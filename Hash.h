@@ -0,0 +1,16 @@
+#ifndef HASH_H
+#define HASH_H
+
+#pragma once
+#include <cstdint>
+#include <string_view>
+
+// Fast non-cryptographic hash for short keys such as words: reads 8 bytes at
+// a time and finishes with a 64-bit avalanche mix. Used by the hash tables.
+std::uint64_t hashBytes(std::string_view bytes) noexcept;
+
+// XXH64 (xxHash, 64-bit) of 'bytes': a content hash for whole files, fast on
+// large inputs (four independent lanes of 8 bytes) and stable across runs.
+std::uint64_t xxHash64(std::string_view bytes, std::uint64_t seed = 0) noexcept;
+
+#endif //HASH_H
@@ -0,0 +1,334 @@
+#include "HuffmanDecoder.h"
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace {
+
+// True if the codes are exactly the canonical codes for their lengths, in order.
+bool isCanonicalCodebook(const std::vector<std::pair<std::string,std::string>>& codebook) {
+    std::uint64_t code = 0;
+    std::size_t prevLength = 0;
+    for (std::size_t i = 0; i < codebook.size(); ++i) {
+        const std::string& bits = codebook[i].second;
+        if (bits.empty() || bits.size() < prevLength || bits.size() > 64) {
+            return false;
+        }
+        if (i > 0) {
+            code = (code + 1) << (bits.size() - prevLength);
+        }
+        prevLength = bits.size();
+        for (std::size_t b = 0; b < bits.size(); ++b) {
+            const char expected = ((code >> (bits.size() - 1 - b)) & 1) ? '1' : '0';
+            if (bits[b] != expected) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+} // End of namespace
+
+void HuffmanDecoder::clear() {
+    words_.clear();
+    trie_.assign(1, TrieNode{});
+    table_.clear();
+    maxLength_ = 0;
+    canonical_ = false;
+    firstCode_.clear();
+    countOf_.clear();
+    firstSymbol_.clear();
+    escapeSymbol_ = NO_CODE;
+}
+
+// Remember which symbol (if any) is the escape for out-of-vocabulary words
+void HuffmanDecoder::findEscape() {
+    const auto it = std::find(words_.begin(), words_.end(), ESCAPE_WORD);
+    escapeSymbol_ = it == words_.end() ? NO_CODE : static_cast<std::uint32_t>(it - words_.begin());
+}
+
+// Build the trie from the codebook, then fill the primary table by walking
+// every possible PRIMARY_BITS-bit prefix through it once.
+error_type HuffmanDecoder::buildTables(const std::vector<std::pair<std::string,std::string>>& codebook) {
+    clear();
+
+    if (codebook.empty()) {
+        return INVALID_HEADER_FILE;
+    }
+
+    // Canonical codes are described by their lengths alone
+    if (isCanonicalCodebook(codebook)) {
+        std::vector<std::string> words;
+        std::vector<int> lengths;
+        for (const auto& [word, code] : codebook) {
+            words.push_back(word);
+            lengths.push_back(static_cast<int>(code.size()));
+        }
+        if (lengths.back() <= MAX_CANONICAL_LENGTH) {
+            return buildCanonicalTables(words, lengths);
+        }
+    }
+
+    // Insert each code into the trie, rejecting codes that aren't prefix-free
+    for (const auto& [word, code] : codebook) {
+        if (code.empty()) {
+            return INVALID_HEADER_FILE;
+        }
+        std::int32_t node = 0;
+        for (char c : code) {
+            if (c != '0' && c != '1') {
+                return INVALID_HEADER_FILE;
+            }
+            if (trie_[node].symbol != -1) {
+                return INVALID_HEADER_FILE; // an earlier code is a prefix of this one
+            }
+            const int bit = c - '0';
+            if (trie_[node].child[bit] == -1) {
+                trie_[node].child[bit] = static_cast<std::int32_t>(trie_.size());
+                trie_.emplace_back();
+            }
+            node = trie_[node].child[bit];
+        }
+        if (trie_[node].symbol != -1 || trie_[node].child[0] != -1 || trie_[node].child[1] != -1) {
+            return INVALID_HEADER_FILE; // duplicate code, or this code is a prefix of another
+        }
+        trie_[node].symbol = static_cast<std::int32_t>(words_.size());
+        words_.push_back(word);
+        maxLength_ = std::max(maxLength_, static_cast<int>(code.size()));
+    }
+
+    // Primary table: no wider than the longest code
+    tableBits_ = std::min(PRIMARY_BITS, maxLength_);
+    table_.resize(std::size_t{1} << tableBits_);
+    for (std::uint32_t prefix = 0; prefix < table_.size(); ++prefix) {
+        std::int32_t node = 0;
+        int depth = 0;
+        while (depth < tableBits_ && node != -1 && trie_[node].symbol == -1) {
+            const int bit = (prefix >> (tableBits_ - 1 - depth)) & 1;
+            node = trie_[node].child[bit];
+            ++depth;
+        }
+
+        Entry& entry = table_[prefix];
+        if (node == -1) {
+            entry.value = NO_CODE;          // no code starts with these bits
+        } else if (trie_[node].symbol != -1) {
+            entry.value = static_cast<std::uint32_t>(trie_[node].symbol);
+            entry.length = static_cast<std::uint8_t>(depth);
+        } else {
+            entry.value = static_cast<std::uint32_t>(node); // slow path resumes here
+        }
+    }
+    findEscape();
+    return NO_ERROR;
+}
+
+// Canonical tables: fill the primary table code by code, and keep the first
+// code of every length for the slow path.
+error_type HuffmanDecoder::buildCanonicalTables(const std::vector<std::string>& words,
+                                                const std::vector<int>& lengths) {
+    clear();
+    if (words.empty() || words.size() != lengths.size()) {
+        return INVALID_HEADER_FILE;
+    }
+
+    maxLength_ = *std::max_element(lengths.begin(), lengths.end());
+    if (maxLength_ > MAX_CANONICAL_LENGTH) {
+        return INVALID_HEADER_FILE;
+    }
+    canonical_ = true;
+    words_ = words;
+    tableBits_ = std::min(PRIMARY_BITS, maxLength_);
+    table_.assign(std::size_t{1} << tableBits_, Entry{NO_CODE, 0});
+    firstCode_.assign(maxLength_ + 1, 0);
+    countOf_.assign(maxLength_ + 1, 0);
+    firstSymbol_.assign(maxLength_ + 1, 0);
+
+    std::uint64_t code = 0;
+    int prevLength = lengths.front();
+    for (std::size_t i = 0; i < lengths.size(); ++i) {
+        const int length = lengths[i];
+        if (length < 1 || length < prevLength) {
+            return INVALID_HEADER_FILE; // not in canonical order
+        }
+        if (i > 0) {
+            code = (code + 1) << (length - prevLength);
+        }
+        prevLength = length;
+        if ((code >> length) != 0) {
+            return INVALID_HEADER_FILE; // more codes than the lengths allow
+        }
+
+        if (countOf_[length]++ == 0) {
+            firstCode_[length] = static_cast<std::uint32_t>(code);
+            firstSymbol_[length] = static_cast<std::uint32_t>(i);
+        }
+
+        if (length <= tableBits_) {
+            // Every table index that starts with this code decodes to it
+            const int spare = tableBits_ - length;
+            const std::size_t begin = static_cast<std::size_t>(code) << spare;
+            for (std::size_t j = 0; j < (std::size_t{1} << spare); ++j) {
+                table_[begin + j] = Entry{static_cast<std::uint32_t>(i), static_cast<std::uint8_t>(length)};
+            }
+        } else {
+            // Longer code: its first tableBits_ bits lead to the slow path
+            table_[code >> (length - tableBits_)] = Entry{0, 0};
+        }
+    }
+    findEscape();
+    return NO_ERROR;
+}
+
+// Decode codes from 'reader' until its bits run out or 'limit' symbols were
+// emitted, passing each symbol to emit(symbol). An escape symbol's literal is
+// read right after it and appended to 'literals' (dropped if that is null).
+template <typename Emit>
+error_type HuffmanDecoder::decodeRun(BitReader& reader, std::uint64_t limit, std::vector<std::string>* literals,
+                                     Emit&& emit) const {
+    std::string literal;
+    auto takeLiteral = [&]() {
+        if (!readLiteral(reader, literal)) {
+            return false;
+        }
+        if (literals != nullptr) {
+            literals->push_back(literal);
+        }
+        return true;
+    };
+
+    while (reader.remaining() > 0 && limit > 0) {
+        const Entry entry = table_[reader.peek(tableBits_)];
+
+        // Fast path: whole code resolved by one probe
+        if (entry.length != 0) {
+            if (entry.length > reader.remaining()) {
+                return CORRUPT_CODE_FILE; // matched only thanks to zero padding
+            }
+            reader.skip(entry.length);
+            emit(entry.value);
+            --limit;
+            if (entry.value == escapeSymbol_ && !takeLiteral()) {
+                return CORRUPT_CODE_FILE;
+            }
+            continue;
+        }
+
+        if (entry.value == NO_CODE || reader.remaining() < static_cast<std::uint64_t>(tableBits_)) {
+            return CORRUPT_CODE_FILE;
+        }
+
+        // Canonical slow path: try each longer length until the code falls in its range
+        if (canonical_) {
+            bool found = false;
+            for (int length = tableBits_ + 1; length <= maxLength_; ++length) {
+                const std::uint32_t offset = reader.peek(length) - firstCode_[length];
+                if (offset < countOf_[length]) {
+                    if (static_cast<std::uint64_t>(length) > reader.remaining()) {
+                        return CORRUPT_CODE_FILE;
+                    }
+                    reader.skip(length);
+                    emit(firstSymbol_[length] + offset);
+                    --limit;
+                    if (firstSymbol_[length] + offset == escapeSymbol_ && !takeLiteral()) {
+                        return CORRUPT_CODE_FILE;
+                    }
+                    found = true;
+                    break;
+                }
+            }
+            if (!found) {
+                return CORRUPT_CODE_FILE;
+            }
+            continue;
+        }
+
+        // Slow path: consume the table bits, then walk the trie one bit at a time
+        reader.skip(tableBits_);
+        std::int32_t node = static_cast<std::int32_t>(entry.value);
+        while (trie_[node].symbol == -1) {
+            if (reader.remaining() == 0) {
+                return CORRUPT_CODE_FILE;
+            }
+            node = trie_[node].child[reader.peek(1)];
+            reader.skip(1);
+            if (node == -1) {
+                return CORRUPT_CODE_FILE;
+            }
+        }
+        emit(static_cast<std::uint32_t>(trie_[node].symbol));
+        --limit;
+        if (static_cast<std::uint32_t>(trie_[node].symbol) == escapeSymbol_ && !takeLiteral()) {
+            return CORRUPT_CODE_FILE;
+        }
+    }
+    return NO_ERROR;
+}
+
+error_type HuffmanDecoder::decodeSymbols(const std::vector<unsigned char>& bytes, std::uint64_t bitCount,
+                                         std::vector<std::uint32_t>& symbols) const {
+    return decodeSymbols(bytes, bitCount, symbols, nullptr);
+}
+
+error_type HuffmanDecoder::decodeSymbols(const std::vector<unsigned char>& bytes, std::uint64_t bitCount,
+                                         std::vector<std::uint32_t>& symbols,
+                                         std::vector<std::string>* literals) const {
+    symbols.clear();
+    if (literals != nullptr) {
+        literals->clear();
+    }
+    if (table_.empty() || bitCount > 8 * static_cast<std::uint64_t>(bytes.size())) {
+        return CORRUPT_CODE_FILE;
+    }
+
+    BitReader reader(bytes.data(), bytes.size(), bitCount);
+    return decodeRun(reader, UINT64_MAX, literals, [&symbols](std::uint32_t s) { symbols.push_back(s); });
+}
+
+// A block holds exactly 'count' codes followed by fewer than 8 zero padding bits
+error_type HuffmanDecoder::decodeBlock(const unsigned char* data, std::size_t size, std::uint64_t count,
+                                       std::uint32_t* out, std::vector<std::string>* literals) const {
+    if (table_.empty()) {
+        return CORRUPT_CODE_FILE;
+    }
+    BitReader reader(data, size, 8 * static_cast<std::uint64_t>(size));
+    std::uint64_t decoded = 0;
+    if (error_type st = decodeRun(reader, count, literals, [&](std::uint32_t s) { out[decoded++] = s; }); st != NO_ERROR) {
+        return st;
+    }
+    const auto padding = static_cast<int>(reader.remaining());
+    if (decoded != count || padding >= 8 || (padding > 0 && reader.peek(padding) != 0)) {
+        return CORRUPT_CODE_FILE;
+    }
+    return NO_ERROR;
+}
+
+error_type HuffmanDecoder::decode(const std::vector<unsigned char>& bytes, std::uint64_t bitCount,
+                                  std::vector<std::string>& tokens) const {
+    std::vector<std::uint32_t> symbols;
+    std::vector<std::string> literals;
+    if (error_type st = decodeSymbols(bytes, bitCount, symbols, &literals); st != NO_ERROR) {
+        return st;
+    }
+    tokens.clear();
+    tokens.reserve(symbols.size());
+    std::size_t nextLiteral = 0;
+    for (std::uint32_t s : symbols) {
+        tokens.push_back(s == escapeSymbol_ ? std::move(literals[nextLiteral++]) : words_[s]);
+    }
+    return NO_ERROR;
+}
+
+const std::string& HuffmanDecoder::word(std::uint32_t symbol) const noexcept {
+    return words_[symbol];
+}
+
+std::size_t HuffmanDecoder::symbolCount() const noexcept {
+    return words_.size();
+}
+
+int HuffmanDecoder::maxCodeLength() const noexcept {
+    return maxLength_;
+}
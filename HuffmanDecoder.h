@@ -0,0 +1,104 @@
+#ifndef HUFFMANDECODER_H
+#define HUFFMANDECODER_H
+
+#pragma once
+#include <cstdint>
+#include <string>
+#include <utility> // std::pair
+#include <vector>
+#include "BitStream.h"
+#include "utils.hpp"
+
+// Table-driven Huffman decoder.
+//
+// Instead of walking TreeNode pointers one bit at a time, the decoder peeks at
+// the next PRIMARY_BITS bits and resolves every code of that length or shorter
+// with a single table lookup. Longer codes fall back to a flat trie (child
+// indices in one vector) starting from the node the table probe already reached.
+// Canonical codes need no trie at all: their slow path compares the next bits
+// against the first code of each length.
+class HuffmanDecoder {
+public:
+    static constexpr int PRIMARY_BITS = 11; // 2048 entries, 16 KB table
+
+    HuffmanDecoder() = default;
+
+    // Build the lookup tables from (word, code) pairs, e.g. from HuffmanTree::readHeader.
+    // Codebooks that are canonical are routed to buildCanonicalTables().
+    // Returns INVALID_HEADER_FILE if the codes are empty or not prefix-free.
+    error_type buildTables(const std::vector<std::pair<std::string,std::string>>& codebook);
+
+    // Build the lookup tables straight from code lengths. 'words' must be in
+    // canonical order (length ascending, then the order codes were assigned).
+    error_type buildCanonicalTables(const std::vector<std::string>& words,
+                                    const std::vector<int>& lengths);
+
+    // Decode bitCount bits from 'bytes' into symbol indices (positions in the codebook).
+    // Returns CORRUPT_CODE_FILE if the bits don't end on a code boundary.
+    error_type decodeSymbols(const std::vector<unsigned char>& bytes, std::uint64_t bitCount,
+                             std::vector<std::uint32_t>& symbols) const;
+
+    // Same, plus the spelling of every escaped word, in order: the i-th escape
+    // symbol in 'symbols' stands for literals[i] (see ESCAPE_WORD).
+    error_type decodeSymbols(const std::vector<unsigned char>& bytes, std::uint64_t bitCount,
+                             std::vector<std::uint32_t>& symbols, std::vector<std::string>* literals) const;
+
+    // Decode one block of the blocked .code container (see BlockCode.h):
+    // exactly 'count' codes from 'size' bytes into out[0..count), followed by
+    // fewer than 8 zero padding bits. Returns CORRUPT_CODE_FILE otherwise.
+    // Escaped words' literals are appended to 'literals' if given.
+    error_type decodeBlock(const unsigned char* data, std::size_t size, std::uint64_t count,
+                           std::uint32_t* out, std::vector<std::string>* literals = nullptr) const;
+
+    // Same, but returns the words themselves (escaped words as spelled).
+    error_type decode(const std::vector<unsigned char>& bytes, std::uint64_t bitCount,
+                      std::vector<std::string>& tokens) const;
+
+    [[nodiscard]] const std::string& word(std::uint32_t symbol) const noexcept;
+    [[nodiscard]] std::size_t symbolCount() const noexcept;
+    [[nodiscard]] int maxCodeLength() const noexcept;
+
+    // True if 'symbol' is the model's ESCAPE_WORD (its token is a literal).
+    [[nodiscard]] bool isEscape(std::uint32_t symbol) const noexcept { return symbol == escapeSymbol_; }
+
+private:
+    // length > 0 : 'value' is the symbol and 'length' the bits it uses.
+    // length == 0: code is longer than the table; 'value' is the trie node to resume from
+    //              (NO_CODE if no code starts with these bits).
+    struct Entry {
+        std::uint32_t value = 0;
+        std::uint8_t length = 0;
+    };
+
+    // Flat binary trie; child == -1 means no edge, symbol == -1 means internal node.
+    struct TrieNode {
+        std::int32_t child[2] = {-1, -1};
+        std::int32_t symbol = -1;
+    };
+
+    static constexpr std::uint32_t NO_CODE = 0xFFFFFFFFu;
+    static constexpr int MAX_CANONICAL_LENGTH = 32; // longest code peek() can return
+
+    std::vector<std::string> words_;
+    std::vector<TrieNode> trie_;
+    std::vector<Entry> table_;
+    int tableBits_ = 0;
+    int maxLength_ = 0;
+
+    // Canonical slow path, indexed by code length
+    bool canonical_ = false;
+    std::vector<std::uint32_t> firstCode_;   // smallest code of each length
+    std::vector<std::uint32_t> countOf_;     // number of codes of each length
+    std::vector<std::uint32_t> firstSymbol_; // symbol index of firstCode_
+
+    std::uint32_t escapeSymbol_ = NO_CODE;   // ESCAPE_WORD's symbol, if the model has one
+
+    void clear();
+    void findEscape();
+
+    template <typename Emit>
+    error_type decodeRun(BitReader& reader, std::uint64_t limit, std::vector<std::string>* literals,
+                         Emit&& emit) const;
+};
+
+#endif //HUFFMANDECODER_H
@@ -4,50 +4,533 @@
 
 #include "HuffmanTree.h"
 #include "PriorityQueue.h"
+#include "BitStream.h"
+#include "BlockCode.h"
+#include "ThreadPool.h"
 #include <vector>
 #include <string>
 #include <iostream>
 #include <sstream>
 #include <unordered_map>
 #include <fstream>
+#include <algorithm>
+
+namespace {
+
+// Package-merge (Larmore & Hirschberg): optimal code lengths with no code
+// longer than maxLength. 'weights' must be in ascending order; 2^maxLength
+// must be at least weights.size() >= 2.
+//
+// Level maxLength holds just the leaves. Each level above merges the leaves
+// with "packages" made by pairing consecutive items of the level below.
+// Taking the cheapest 2n-2 items of the top level, every leaf item taken adds
+// one to that symbol's length, and every package taken pulls its two items
+// from the level below. Leaves appear in every level in weight order, so a
+// level only needs to remember which of its items are packages.
+std::vector<int> packageMergeLengths(const std::vector<std::uint64_t>& weights, int maxLength) {
+    const std::size_t n = weights.size();
+    std::vector<std::vector<bool>> isPackage(maxLength + 1);
+
+    // Weights of the current level's items (start from the bottom level = leaves)
+    std::vector<std::uint64_t> level(weights);
+    isPackage[maxLength].assign(n, false);
+    for (int j = maxLength - 1; j >= 1; --j) {
+        std::vector<std::uint64_t> next;
+        next.reserve(n + level.size() / 2);
+        std::vector<bool>& kinds = isPackage[j];
+        kinds.reserve(n + level.size() / 2);
+
+        // Merge leaves with packages of the level below (leaves first on ties)
+        std::size_t leaf = 0;
+        std::size_t pair = 0;
+        const std::size_t packages = level.size() / 2;
+        while (leaf < n || pair < packages) {
+            const bool takeLeaf = pair == packages ||
+                                  (leaf < n && weights[leaf] <= level[2 * pair] + level[2 * pair + 1]);
+            if (takeLeaf) {
+                next.push_back(weights[leaf++]);
+                kinds.push_back(false);
+            } else {
+                next.push_back(level[2 * pair] + level[2 * pair + 1]);
+                kinds.push_back(true);
+                ++pair;
+            }
+        }
+        level = std::move(next);
+    }
+
+    // Walk down from the top, expanding the packages that were taken
+    std::vector<int> lengths(n, 0);
+    std::size_t take = 2 * n - 2;
+    for (int j = 1; j <= maxLength && take > 0; ++j) {
+        std::size_t leaf = 0;
+        std::size_t packages = 0;
+        for (std::size_t i = 0; i < take; ++i) {
+            if (isPackage[j][i]) {
+                ++packages;
+            } else {
+                ++lengths[leaf++];
+            }
+        }
+        take = 2 * packages;
+    }
+    return lengths;
+}
+
+// Smallest length limit that can hold n distinct codes
+int minimumCodeLength(std::size_t n) {
+    int bits = 1;
+    while ((std::size_t{1} << bits) < n) {
+        ++bits;
+    }
+    return bits;
+}
+
+// Write the codes of tokens 0..count-1 (codeOf(i) = code of token i) in
+// 'format': packed bits, or ASCII '0'/'1' wrapped to wrap_cols per line.
+// after(writer, i) runs once token i's code is out (escape literals).
+template <typename CodeOf, typename AfterToken>
+error_type writeEncoded(std::size_t count, CodeOf&& codeOf, std::ostream& os_bits,
+                        CodeFormat format, int wrap_cols, AfterToken&& after) {
+    // Binary: pack the bits straight into bytes, no intermediate string
+    if (format == CodeFormat::BINARY) {
+        BitWriter writer(os_bits);
+        for (std::size_t i = 0; i < count; ++i) {
+            writer.putBits(codeOf(i));
+            after(writer, i);
+        }
+        return writer.finish();
+    }
+    if (format == CodeFormat::BLOCKED) {
+        BlockWriter writer(os_bits);
+        for (std::size_t i = 0; i < count; ++i) {
+            writer.putBits(codeOf(i));
+            after(writer, i);
+        }
+        return writer.finish();
+    }
+
+    // ASCII: '0'/'1' characters, 80 per line by default
+    TextBitWriter writer(os_bits, wrap_cols);
+    for (std::size_t i = 0; i < count; ++i) {
+        writer.putBits(codeOf(i)); // BitCode of the i-th token's symbol ID
+        after(writer, i);
+    }
+    return writer.finish();
+}
+
+template <typename CodeOf>
+error_type writeEncoded(std::size_t count, CodeOf&& codeOf, std::ostream& os_bits,
+                        CodeFormat format, int wrap_cols) {
+    return writeEncoded(count, std::forward<CodeOf>(codeOf), os_bits, format, wrap_cols,
+                        [](auto&, std::size_t) {});
+}
+
+// Encode with a code table, following every 'escape' symbol with the next
+// of 'literals' (see putLiteral)
+template <typename Code>
+error_type writeWithEscapes(const std::vector<Code>& codes, std::uint32_t escape,
+                            const std::vector<std::uint32_t>& symbols,
+                            const std::vector<std::string>& literals,
+                            std::ostream& os_bits, CodeFormat format, int wrap_cols) {
+    if (static_cast<std::size_t>(std::ranges::count(symbols, escape)) != literals.size()) {
+        return WORD_NOT_IN_CODEBOOK;
+    }
+    std::size_t next = 0;
+    return writeEncoded(symbols.size(), [&](std::size_t i) -> const Code& { return codes[symbols[i]]; },
+                        os_bits, format, wrap_cols, [&](auto& writer, std::size_t i) {
+                            if (symbols[i] == escape) {
+                                putLiteral(writer, literals[next++]);
+                            }
+                        });
+}
+
+// Parallel encoding works through the stream ENCODE_ROUND_TOKENS at a time
+// (bounding the output buffer), cut into chunks of at least
+// ENCODE_CHUNK_TOKENS; smaller streams are encoded serially.
+constexpr std::size_t ENCODE_CHUNK_TOKENS = 1 << 16;
+constexpr std::size_t ENCODE_ROUND_TOKENS = 1 << 22;
+
+// Packs one chunk's codes (most significant bit first) into a byte buffer
+// shared by all chunks, starting at bit 'bitOffset'. The chunk's first byte
+// may also hold bits of the chunk before it, so that byte goes to 'head' and
+// is ORed in once every chunk is done. Every later byte is written by this
+// chunk alone (the next chunk sends its shared first byte to its own head).
+class OffsetPacker {
+public:
+    OffsetPacker(unsigned char* out, std::uint64_t bitOffset, unsigned char& head)
+        : out_(out), first_(bitOffset / 8), next_(first_), head_(head),
+          used_(static_cast<int>(bitOffset % 8)) {} // leading zeros stand in for earlier bits
+
+    void putBits(BitCode code) {
+        if (code.length < 64 - used_) {
+            acc_ = (acc_ << code.length) | code.bits;
+            used_ += code.length;
+            return;
+        }
+        const int rest = used_ + code.length - 64;
+        const std::uint64_t word = (used_ == 0 ? 0 : acc_ << (64 - used_)) | (code.bits >> rest);
+        for (int i = 0; i < 8; ++i) {
+            storeByte(static_cast<unsigned char>(word >> (56 - 8 * i)));
+        }
+        acc_ = rest == 0 ? 0 : code.bits & ((std::uint64_t{1} << rest) - 1);
+        used_ = rest;
+    }
+
+    // Store the last partial bytes, zero-padded on the right
+    void finish() {
+        const std::uint64_t word = used_ == 0 ? 0 : acc_ << (64 - used_);
+        for (int i = 0; i < (used_ + 7) / 8; ++i) {
+            storeByte(static_cast<unsigned char>(word >> (56 - 8 * i)));
+        }
+    }
+
+private:
+    unsigned char* out_;
+    std::size_t first_;
+    std::size_t next_;
+    unsigned char& head_;
+    std::uint64_t acc_ = 0;
+    int used_;
+
+    void storeByte(unsigned char byte) {
+        if (next_ == first_) {
+            head_ = byte;
+        } else {
+            out_[next_] = byte;
+        }
+        ++next_;
+    }
+};
+
+// Binary format on 'pool': the same bytes and trailer as BitWriter
+error_type encodeBinaryParallel(const std::vector<BitCode>& codes, const std::vector<std::uint32_t>& symbols,
+                                std::ostream& os, ThreadPool& pool) {
+    const std::size_t chunkCount = std::max<std::size_t>(
+        1, std::min<std::size_t>(4 * pool.size(), ENCODE_ROUND_TOKENS / ENCODE_CHUNK_TOKENS));
+    std::vector<std::uint64_t> offsets;
+    std::vector<unsigned char> heads;
+    std::vector<unsigned char> buffer;
+    std::uint64_t totalBits = 0;
+    unsigned char carry = 0; // unfinished last byte of the previous round
+
+    for (std::size_t begin = 0; begin < symbols.size(); begin += ENCODE_ROUND_TOKENS) {
+        const std::size_t end = std::min(symbols.size(), begin + ENCODE_ROUND_TOKENS);
+        const std::size_t chunks = std::min(chunkCount, (end - begin + ENCODE_CHUNK_TOKENS - 1) / ENCODE_CHUNK_TOKENS);
+        const std::size_t per = (end - begin + chunks - 1) / chunks;
+        auto chunkBegin = [&](std::size_t i) { return std::min(end, begin + i * per); };
+
+        // Pass 1: bits per chunk, then a prefix sum into bit offsets within the
+        // round's buffer (whose first byte is the carried partial byte)
+        offsets.assign(chunks + 1, 0);
+        pool.parallelFor(chunks, [&](std::size_t i) {
+            std::uint64_t bits = 0;
+            for (std::size_t t = chunkBegin(i); t < chunkBegin(i + 1); ++t) {
+                bits += codes[symbols[t]].length;
+            }
+            offsets[i + 1] = bits;
+        });
+        offsets[0] = totalBits % 8;
+        for (std::size_t i = 0; i < chunks; ++i) {
+            offsets[i + 1] += offsets[i];
+        }
+
+        // Pass 2: every chunk packs its codes at its own offset
+        buffer.assign((offsets[chunks] + 7) / 8, 0);
+        heads.assign(chunks, 0);
+        pool.parallelFor(chunks, [&](std::size_t i) {
+            OffsetPacker packer(buffer.data(), offsets[i], heads[i]);
+            for (std::size_t t = chunkBegin(i); t < chunkBegin(i + 1); ++t) {
+                packer.putBits(codes[symbols[t]]);
+            }
+            packer.finish();
+        });
+        if (!buffer.empty()) {
+            buffer[0] |= carry;
+        }
+        for (std::size_t i = 0; i < chunks; ++i) {
+            if (offsets[i] / 8 < buffer.size()) {
+                buffer[offsets[i] / 8] |= heads[i];
+            }
+        }
+
+        // Whole bytes go out; a partial last byte carries into the next round
+        const std::size_t whole = offsets[chunks] / 8;
+        os.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(whole));
+        carry = whole < buffer.size() ? buffer[whole] : 0;
+        totalBits += offsets[chunks] - offsets[0];
+    }
+
+    if (totalBits % 8 != 0) {
+        os.put(static_cast<char>(carry));
+    }
+    for (std::size_t i = 0; i < BitWriter::TRAILER_BYTES; ++i) {
+        os.put(static_cast<char>((totalBits >> (8 * i)) & 0xFF));
+    }
+    return os ? NO_ERROR : FAILED_TO_WRITE_FILE;
+}
+
+// ASCII format on 'pool'. Bit b of the message is character b + b / wrap_cols
+// of the file (one newline per full line before it), so chunks share nothing.
+error_type encodeAsciiParallel(const std::vector<BitCode>& codes, const std::vector<std::uint32_t>& symbols,
+                               std::ostream& os, ThreadPool& pool, int wrap_cols) {
+    const auto wrap = static_cast<std::uint64_t>(wrap_cols);
+    auto charOf = [wrap](std::uint64_t bit) { return bit + bit / wrap; };
+    const std::size_t chunkCount = std::max<std::size_t>(
+        1, std::min<std::size_t>(4 * pool.size(), ENCODE_ROUND_TOKENS / ENCODE_CHUNK_TOKENS));
+    std::vector<std::uint64_t> offsets;
+    std::string buffer;
+    std::uint64_t totalBits = 0;
+
+    for (std::size_t begin = 0; begin < symbols.size(); begin += ENCODE_ROUND_TOKENS) {
+        const std::size_t end = std::min(symbols.size(), begin + ENCODE_ROUND_TOKENS);
+        const std::size_t chunks = std::min(chunkCount, (end - begin + ENCODE_CHUNK_TOKENS - 1) / ENCODE_CHUNK_TOKENS);
+        const std::size_t per = (end - begin + chunks - 1) / chunks;
+        auto chunkBegin = [&](std::size_t i) { return std::min(end, begin + i * per); };
+
+        // Pass 1: bits per chunk -> absolute bit offsets
+        offsets.assign(chunks + 1, 0);
+        pool.parallelFor(chunks, [&](std::size_t i) {
+            std::uint64_t bits = 0;
+            for (std::size_t t = chunkBegin(i); t < chunkBegin(i + 1); ++t) {
+                bits += codes[symbols[t]].length;
+            }
+            offsets[i + 1] = bits;
+        });
+        offsets[0] = totalBits;
+        for (std::size_t i = 0; i < chunks; ++i) {
+            offsets[i + 1] += offsets[i];
+        }
+
+        // Pass 2: characters (and the newlines inside them) at their final places
+        const std::uint64_t base = charOf(offsets[0]);
+        buffer.resize(charOf(offsets[chunks]) - base);
+        pool.parallelFor(chunks, [&](std::size_t i) {
+            std::size_t pos = charOf(offsets[i]) - base;
+            std::uint64_t column = offsets[i] % wrap;
+            for (std::size_t t = chunkBegin(i); t < chunkBegin(i + 1); ++t) {
+                const BitCode code = codes[symbols[t]];
+                for (int b = code.length - 1; b >= 0; --b) {
+                    buffer[pos++] = ((code.bits >> b) & 1) != 0 ? '1' : '0';
+                    if (++column == wrap) {
+                        buffer[pos++] = '\n';
+                        column = 0;
+                    }
+                }
+            }
+        });
+        os.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        totalBits = offsets[chunks];
+    }
+
+    // end with new line
+    if (totalBits % wrap != 0) {
+        os.put('\n');
+    }
+    return os ? NO_ERROR : FAILED_TO_WRITE_FILE;
+}
+
+// Blocked format on 'pool': blocks are independent, so a round of blocks is
+// packed in parallel, each into its own buffer, and appended in order
+error_type encodeBlockedParallel(const std::vector<BitCode>& codes, const std::vector<std::uint32_t>& symbols,
+                                 std::ostream& os, ThreadPool& pool) {
+    BlockWriter writer(os);
+    const std::size_t perBlock = writer.tokensPerBlock();
+    const std::size_t blocksPerRound = 4 * pool.size();
+    std::vector<std::string> packed(blocksPerRound);
+    for (std::size_t begin = 0; begin < symbols.size(); begin += blocksPerRound * perBlock) {
+        const std::size_t blocks = std::min(blocksPerRound, (symbols.size() - begin + perBlock - 1) / perBlock);
+        auto blockBegin = [&](std::size_t b) { return std::min(symbols.size(), begin + b * perBlock); };
+        pool.parallelFor(blocks, [&](std::size_t b) {
+            std::ostringstream block;
+            BitWriter bits(block);
+            for (std::size_t t = blockBegin(b); t < blockBegin(b + 1); ++t) {
+                bits.putBits(codes[symbols[t]]);
+            }
+            bits.alignToByte();
+            bits.flush();
+            packed[b] = std::move(block).str();
+        });
+        for (std::size_t b = 0; b < blocks; ++b) {
+            writer.putBlock(packed[b], blockBegin(b + 1) - blockBegin(b));
+        }
+    }
+    return writer.finish();
+}
+
+} // End of namespace
 
 // Static factory method to build HuffmanTree from word counts
-HuffmanTree HuffmanTree::buildFromCounts(const std::vector<std::pair<std::string,int>>& counts) {
-    // Convert (word, count) pairs to TreeNode* objects
+HuffmanTree HuffmanTree::buildFromCounts(const std::vector<std::pair<std::string,int>>& counts,
+                                         const HuffmanBuildOptions& options) {
+    // Symbols are numbered in lexicographic word order. BST output already is
+    // in that order, so the symbol is just the index; otherwise sort once.
+    std::vector<std::size_t> order(counts.size());
+    for (std::size_t i = 0; i < order.size(); ++i) order[i] = i;
+    if (!std::ranges::is_sorted(counts, {}, &std::pair<std::string,int>::first)) {
+        std::ranges::sort(order, [&counts](std::size_t a, std::size_t b) {
+            return counts[a].first < counts[b].first;
+        });
+    }
+
+    std::vector<int> freqs;
+    std::vector<std::string_view> words;
+    freqs.reserve(counts.size());
+    words.reserve(counts.size());
+    for (std::size_t i : order) {
+        words.push_back(counts[i].first);
+        freqs.push_back(counts[i].second);
+    }
+    return buildFromSymbolCounts(freqs, words, options);
+}
+
+// Build from per-symbol counts (symbol = lexicographic rank of its word)
+HuffmanTree HuffmanTree::buildFromSymbolCounts(const std::vector<int>& freqs,
+                                               const std::vector<std::string_view>& words,
+                                               const HuffmanBuildOptions& options) {
+    HuffmanTree tree = buildUnbounded(freqs, words, options.strategy);
+    if (options.maxCodeLength <= 0 || tree.root_ == nullptr || tree.maxCodeLength() <= options.maxCodeLength) {
+        return tree; // already within the limit: keep the optimal tree as-is
+    }
+
+    // Too deep: keep the leaves, recompute their lengths under the limit,
+    // and rebuild the tree in canonical shape from those lengths.
+    const int limit = std::max(options.maxCodeLength, minimumCodeLength(freqs.size()));
+    std::vector<std::pair<TreeNode*, int>> leaves;
+    collectLeaves(tree.root_, 0, leaves);
+    tree.root_ = nullptr; // old internal nodes stay in the arena until the tree goes
+
+    // Ascending weight, in the same order the merge would extract them
+    std::ranges::sort(leaves, [](const auto& a, const auto& b) {
+        return PriorityQueue::higherPriority(a.first, b.first);
+    });
+    std::vector<std::uint64_t> weights;
+    weights.reserve(leaves.size());
+    for (const auto& [leaf, depth] : leaves) {
+        weights.push_back(static_cast<std::uint64_t>(leaf->freq));
+    }
+    const std::vector<int> lengths = packageMergeLengths(weights, limit);
+    for (std::size_t i = 0; i < leaves.size(); ++i) {
+        leaves[i].second = lengths[i];
+    }
+    tree.root_ = buildCanonicalShape(leaves, tree.arena_);
+    return tree;
+}
+
+// Plain Huffman construction (no length limit)
+HuffmanTree HuffmanTree::buildUnbounded(const std::vector<int>& freqs,
+                                        const std::vector<std::string_view>& words,
+                                        MergeStrategy strategy) {
+    // Every node (n leaves, n - 1 parents) comes from the tree's arena
+    HuffmanTree tree;
+    tree.arena_ = NodeArena(freqs.empty() ? 1 : 2 * freqs.size() - 1);
+
+    // Convert (word, count) pairs to TreeNode* objects; the symbol is the rank
     std::vector<TreeNode*> nodes;
-    for (const auto& [word, freq]: counts) {
-        TreeNode* node = new TreeNode(word);
-        node->freq = freq;
+    nodes.reserve(freqs.size());
+    for (std::size_t i = 0; i < freqs.size(); ++i) {
+        TreeNode* node = tree.arena_.make(words[i]);
+        node->freq = freqs[i];
+        node->rank = static_cast<int>(i);
         nodes.push_back(node);
     }
-    
-    // Create PriorityQueue with the nodes
-    PriorityQueue pq(nodes);
-    
-    //While more than one node exists, extract and combine
-    while(pq.size() > 1) {
-        // Extract 2 values and sum their frequencies
-        TreeNode* a = pq.extractMin();
-        TreeNode* b = pq.extractMin();
 
-        TreeNode* parent = new TreeNode("");
+    // Parent of the two nodes just taken out; internal nodes carry no word
+    auto merge = [&tree](TreeNode* a, TreeNode* b) {
+        TreeNode* parent = tree.arena_.make("");
         parent->freq = a->freq + b->freq;
-        parent->key_word = min(a->key_word, b->key_word);
-        parent->left = a;   // b as left child (matches reference implementation)
-        parent->right = b;  // a as right child (matches reference implementation) 
+        parent->rank = std::min(a->rank, b->rank);
+        parent->left = a;   // first extracted goes left (matches reference implementation)
+        parent->right = b;  // second extracted goes right (matches reference implementation)
+        return parent;
+    };
 
-        pq.insert(parent);
+    if (nodes.empty()) {
+        return tree;
     }
 
-    //Create the huffman tree and pass it the root node
-    HuffmanTree tree;
-    tree.root_ = pq.extractMin(); //last node
+    if (strategy == MergeStrategy::HEAP) {
+        // Create PriorityQueue with the nodes
+        PriorityQueue pq(std::move(nodes));
+
+        //While more than one node exists, extract and combine
+        while (pq.size() > 1) {
+            TreeNode* a = pq.extractMin();
+            TreeNode* b = pq.extractMin();
+            pq.insert(merge(a, b));
+        }
+        tree.root_ = pq.extractMin(); //last node
+        return tree;
+    }
+
+    // Two-queue merge: leaves sorted in extraction order, merged nodes appended
+    // to a second queue. Each merge sums the two smallest remaining frequencies,
+    // so merged nodes are created already in extraction order.
+    std::ranges::sort(nodes, PriorityQueue::higherPriority);
+    std::vector<TreeNode*> merged;
+    merged.reserve(nodes.size());
+    std::size_t leafHead = 0;
+    std::size_t mergedHead = 0;
+
+    auto takeMin = [&]() {
+        if (mergedHead == merged.size() ||
+            (leafHead < nodes.size() && PriorityQueue::higherPriority(nodes[leafHead], merged[mergedHead]))) {
+            return nodes[leafHead++];
+        }
+        return merged[mergedHead++];
+    };
+
+    for (std::size_t remaining = nodes.size(); remaining > 1; --remaining) {
+        TreeNode* a = takeMin();
+        TreeNode* b = takeMin();
+        merged.push_back(merge(a, b));
+    }
+    tree.root_ = merged.empty() ? nodes.front() : merged.back();
     return tree;
 }
 
-// Destructor - deletes the entire Huffman tree
-HuffmanTree::~HuffmanTree() {
-    destroy(root_);
+// Longest code in the tree (a lone word still gets the 1-bit code "0")
+int HuffmanTree::maxCodeLength() const {
+    if (root_ == nullptr) {
+        return 0;
+    }
+    std::vector<std::pair<TreeNode*, int>> leaves;
+    collectLeaves(root_, 0, leaves);
+    int longest = 1;
+    for (const auto& [leaf, depth] : leaves) {
+        longest = std::max(longest, depth);
+    }
+    return longest;
+}
+
+// Bits needed to encode the counted tokens: sum of freq * code length
+std::uint64_t HuffmanTree::encodedBits() const {
+    if (root_ == nullptr) {
+        return 0;
+    }
+    std::vector<std::pair<TreeNode*, int>> leaves;
+    collectLeaves(root_, 0, leaves);
+    std::uint64_t bits = 0;
+    for (const auto& [leaf, depth] : leaves) {
+        bits += static_cast<std::uint64_t>(leaf->freq) * static_cast<std::uint64_t>(std::max(depth, 1));
+    }
+    return bits;
+}
+
+// Move: take over the other tree's nodes (and the arena holding them) and leave it empty
+HuffmanTree::HuffmanTree(HuffmanTree&& other) noexcept
+    : root_(other.root_), canonical_(other.canonical_), arena_(std::move(other.arena_)) {
+    other.root_ = nullptr;
+}
+
+HuffmanTree& HuffmanTree::operator=(HuffmanTree&& other) noexcept {
+    if (this != &other) {
+        root_ = other.root_;
+        canonical_ = other.canonical_;
+        arena_ = std::move(other.arena_); // frees our old nodes
+        other.root_ = nullptr;
+    }
+    return *this;
 }
 
 // Build a vector of (word, code) pairs by traversing the Huffman tree
@@ -60,71 +543,349 @@ void HuffmanTree::assignCodes(std::vector<std::pair<std::string,std::string>>& o
     assignCodesDFS(root_, prefix, out);
 }
 
+// Codes indexed by symbol (leaf rank) instead of by word
+void HuffmanTree::codeTable(std::vector<std::string>& codes) const {
+    codes.clear();
+    if (root_ == nullptr) {
+        return;
+    }
+    std::string prefix;
+    codeTableDFS(root_, prefix, codes);
+}
+
+// Same table as (bits, length) integers
+bool HuffmanTree::codeTable(std::vector<BitCode>& codes) const {
+    codes.clear();
+    if (root_ == nullptr) {
+        return true;
+    }
+    return codeTableDFS(root_, 0, 0, codes);
+}
+
+// Rebuild the tree in canonical shape, keeping every leaf's depth
+void HuffmanTree::makeCanonical() {
+    canonical_ = true;
+
+    // A single word has no internal nodes; its code "0" is already canonical
+    if (root_ == nullptr || (root_->left == nullptr && root_->right == nullptr)) {
+        return;
+    }
+
+    // Keep the leaves and their depths (= code lengths), drop the internal nodes
+    std::vector<std::pair<TreeNode*, int>> leaves;
+    collectLeaves(root_, 0, leaves);
+    root_ = buildCanonicalShape(leaves, arena_);
+}
+
+bool HuffmanTree::isCanonical() const noexcept {
+    return canonical_;
+}
+
 // Header writer (pre-order over leaves; "word<space>code"; newline at end)
 error_type HuffmanTree::writeHeader(std::ostream& os) const {
     if(root_ == nullptr) {
         return NO_ERROR;
     }
+
+    // Compact canonical header: counts per code length, then the words in code order
+    if (canonical_) {
+        std::vector<std::pair<std::string, std::string>> codebook;
+        assignCodes(codebook); // pre-order over a canonical tree = canonical order
+        return writeCodebookHeader(os, codebook, true);
+    }
+
     std::string prefix = "";
     writeHeaderPreorder(root_, os, prefix);
     return NO_ERROR;
 }
 
+// Either header form from a pre-order codebook
+error_type HuffmanTree::writeCodebookHeader(std::ostream& os,
+                                            const std::vector<std::pair<std::string,std::string>>& codebook,
+                                            bool canonical) {
+    if (!canonical) {
+        for (const auto& [word, code] : codebook) {
+            os << word << ' ' << code << '\n';
+        }
+        return os ? NO_ERROR : FAILED_TO_WRITE_FILE;
+    }
+
+    std::vector<std::size_t> perLength;
+    for (const auto& [word, code] : codebook) {
+        if (perLength.size() < code.size()) {
+            perLength.resize(code.size(), 0);
+        }
+        perLength[code.size() - 1]++;
+    }
+
+    os << "#canonical\n";
+    for (std::size_t i = 0; i < perLength.size(); ++i) {
+        os << (i == 0 ? "" : " ") << perLength[i];
+    }
+    os << '\n';
+    for (const auto& [word, code] : codebook) {
+        os << word << '\n';
+    }
+    return os ? NO_ERROR : FAILED_TO_WRITE_FILE;
+}
+
+// Header reader: one "word code" pair per line, or the canonical form
+error_type HuffmanTree::readHeader(std::istream& is,
+                                   std::vector<std::pair<std::string,std::string>>& codebook) {
+    codebook.clear();
+    std::string line;
+
+    // An empty input's header is empty too: no words, no codes
+    if (is && is.peek() == std::char_traits<char>::eof()) {
+        return NO_ERROR;
+    }
+
+    // Canonical header: rebuild each code from the per-length counts
+    if (is.peek() == '#') {
+        std::getline(is, line);
+        if (line != "#canonical" || !std::getline(is, line)) {
+            return INVALID_HEADER_FILE;
+        }
+        std::vector<std::size_t> perLength;
+        std::istringstream counts(line);
+        for (std::size_t n; counts >> n; ) {
+            perLength.push_back(n);
+        }
+        if (!counts.eof() || perLength.empty() || perLength.size() > 64) {
+            return INVALID_HEADER_FILE;
+        }
+
+        std::uint64_t code = 0;
+        for (std::size_t length = 1; length <= perLength.size(); ++length) {
+            for (std::size_t k = 0; k < perLength[length - 1]; ++k) {
+                if (!std::getline(is, line) || line.empty() || line.find(' ') != std::string::npos) {
+                    return INVALID_HEADER_FILE;
+                }
+                // Kraft check: the code must still fit in 'length' bits
+                if (length < 64 && (code >> length) != 0) {
+                    return INVALID_HEADER_FILE;
+                }
+                std::string bits(length, '0');
+                for (std::size_t b = 0; b < length; ++b) {
+                    if ((code >> (length - 1 - b)) & 1) bits[b] = '1';
+                }
+                codebook.emplace_back(line, std::move(bits));
+                ++code;
+            }
+            code <<= 1;
+        }
+        return codebook.empty() ? INVALID_HEADER_FILE : NO_ERROR;
+    }
+
+    while (std::getline(is, line)) {
+        if (line.empty()) {
+            continue;
+        }
+        const std::size_t space = line.find(' ');
+        if (space == std::string::npos || space == 0 || space + 1 == line.size()) {
+            return INVALID_HEADER_FILE;
+        }
+        codebook.emplace_back(line.substr(0, space), line.substr(space + 1));
+    }
+    return codebook.empty() ? INVALID_HEADER_FILE : NO_ERROR;
+}
+
 // Encode a sequence of tokens using the codebook derived from this tree
 error_type HuffmanTree::encode(const std::vector<std::string>& tokens,
                                std::ostream& os_bits,
                                int wrap_cols) const {
-    
+    return encode(tokens, os_bits, CodeFormat::ASCII, wrap_cols);
+}
 
+// Encode in the requested format (ASCII '0'/'1' lines or packed binary)
+error_type HuffmanTree::encode(const std::vector<std::string>& tokens,
+                               std::ostream& os_bits,
+                               CodeFormat format,
+                               int wrap_cols) const {
     // Build the codebook
     std::vector<std::pair<std::string, std:: string>> codebook;
     assignCodes(codebook);
 
-    //Unordered map named codes
-    std::unordered_map<std::string, std::string> codes;
+    // Number the words by codebook position and turn the tokens into those
+    // numbers; a token the tree has no code for is an error, never a new key
+    std::unordered_map<std::string_view, std::uint32_t> positionOf;
+    std::vector<std::string> codes;
+    positionOf.reserve(codebook.size());
+    codes.reserve(codebook.size());
+    for (const auto& [word, code] : codebook) {
+        positionOf.emplace(word, static_cast<std::uint32_t>(codes.size()));
+        codes.push_back(code);
+    }
+    // Unless the codebook has an escape word: then a missing token is sent
+    // as the escape followed by its spelling
+    const auto escape = positionOf.find(ESCAPE_WORD);
+    std::vector<std::uint32_t> symbols;
+    std::vector<std::string> literals;
+    symbols.reserve(tokens.size());
+    for (const std::string& token : tokens) {
+        const auto it = positionOf.find(token);
+        if (it != positionOf.end()) {
+            symbols.push_back(it->second);
+        } else if (escape != positionOf.end()) {
+            symbols.push_back(escape->second);
+            literals.push_back(token);
+        } else {
+            return WORD_NOT_IN_CODEBOOK;
+        }
+    }
 
+    if (!literals.empty()) {
+        return encodeWithEscapes(codes, escape->second, symbols, literals, os_bits, format, wrap_cols);
+    }
+    return encodeWithTable(codes, symbols, os_bits, format, wrap_cols);
+}
 
-    // Read the codebook now
-    for (auto& [word, code] : codebook) {
-        codes[word] = code; // map the word to its code
+// Encode symbol IDs: the integer code table is indexed directly, no hashing
+error_type HuffmanTree::encode(const std::vector<std::uint32_t>& symbols,
+                               std::ostream& os_bits,
+                               CodeFormat format,
+                               int wrap_cols) const {
+    std::vector<BitCode> codes;
+    if (codeTable(codes)) {
+        return encodeWithTable(codes, symbols, os_bits, format, wrap_cols);
     }
+    std::vector<std::string> longCodes;
+    codeTable(longCodes);
+    return encodeWithTable(longCodes, symbols, os_bits, format, wrap_cols);
+}
 
-    //Encode each word
-    std::string encodedWords = "";
-    for (const std::string& token : tokens) {
-        encodedWords += codes[token]; //Grabs codes["the"] returns its code example: "101010" 
+// Encode symbol IDs on a thread pool (integer codes only; longer codes stay serial)
+error_type HuffmanTree::encode(const std::vector<std::uint32_t>& symbols,
+                               std::ostream& os_bits,
+                               CodeFormat format,
+                               ThreadPool& pool,
+                               int wrap_cols) const {
+    std::vector<BitCode> codes;
+    if (codeTable(codes)) {
+        return encodeWithTable(codes, symbols, os_bits, format, pool, wrap_cols);
     }
+    return encode(symbols, os_bits, format, wrap_cols);
+}
 
-    // Write the continuous encoded message out with 80 line limit
-    int lineLength = 0;
-    for (char bit : encodedWords) {
-        os_bits << bit;
-        lineLength++;
+error_type HuffmanTree::encodeWithTable(const std::vector<BitCode>& codes,
+                                        const std::vector<std::uint32_t>& symbols,
+                                        std::ostream& os_bits,
+                                        CodeFormat format,
+                                        ThreadPool& pool,
+                                        int wrap_cols) {
+    if (pool.size() <= 1 || symbols.size() < 2 * ENCODE_CHUNK_TOKENS ||
+        (format == CodeFormat::ASCII && wrap_cols <= 0)) {
+        return encodeWithTable(codes, symbols, os_bits, format, wrap_cols);
+    }
+    if (format == CodeFormat::BINARY) {
+        return encodeBinaryParallel(codes, symbols, os_bits, pool);
+    }
+    if (format == CodeFormat::BLOCKED) {
+        return encodeBlockedParallel(codes, symbols, os_bits, pool);
+    }
+    return encodeAsciiParallel(codes, symbols, os_bits, pool, wrap_cols);
+}
 
-        //Size 80 is default for program
-        if(lineLength == wrap_cols) {
-            os_bits << '\n';
-            lineLength = 0;
-        }
+// Encode symbol IDs through any symbol-indexed code table (shared with FlatHuffmanTree)
+error_type HuffmanTree::encodeWithTable(const std::vector<BitCode>& codes,
+                                        const std::vector<std::uint32_t>& symbols,
+                                        std::ostream& os_bits,
+                                        CodeFormat format,
+                                        int wrap_cols) {
+    return writeEncoded(symbols.size(), [&](std::size_t i) { return codes[symbols[i]]; },
+                        os_bits, format, wrap_cols);
+}
+
+error_type HuffmanTree::encodeWithTable(const std::vector<std::string>& codes,
+                                        const std::vector<std::uint32_t>& symbols,
+                                        std::ostream& os_bits,
+                                        CodeFormat format,
+                                        int wrap_cols) {
+    if (std::ranges::all_of(codes, [](const std::string& c) { return c.size() <= BitCode::MAX_LENGTH; })) {
+        std::vector<BitCode> bitCodes(codes.size());
+        std::ranges::transform(codes, bitCodes.begin(), BitCode::fromString);
+        return encodeWithTable(bitCodes, symbols, os_bits, format, wrap_cols);
     }
-    
-    //  end with new line 
-    if (lineLength > 0) {
-        os_bits << '\n';
+    return writeEncoded(symbols.size(), [&](std::size_t i) -> const std::string& { return codes[symbols[i]]; },
+                        os_bits, format, wrap_cols);
+}
+
+error_type HuffmanTree::encodeWithEscapes(const std::vector<BitCode>& codes,
+                                          std::uint32_t escape,
+                                          const std::vector<std::uint32_t>& symbols,
+                                          const std::vector<std::string>& literals,
+                                          std::ostream& os_bits,
+                                          CodeFormat format,
+                                          int wrap_cols) {
+    return writeWithEscapes(codes, escape, symbols, literals, os_bits, format, wrap_cols);
+}
+
+error_type HuffmanTree::encodeWithEscapes(const std::vector<std::string>& codes,
+                                          std::uint32_t escape,
+                                          const std::vector<std::uint32_t>& symbols,
+                                          const std::vector<std::string>& literals,
+                                          std::ostream& os_bits,
+                                          CodeFormat format,
+                                          int wrap_cols) {
+    if (std::ranges::all_of(codes, [](const std::string& c) { return c.size() <= BitCode::MAX_LENGTH; })) {
+        std::vector<BitCode> bitCodes(codes.size());
+        std::ranges::transform(codes, bitCodes.begin(), BitCode::fromString);
+        return writeWithEscapes(bitCodes, escape, symbols, literals, os_bits, format, wrap_cols);
     }
+    return writeWithEscapes(codes, escape, symbols, literals, os_bits, format, wrap_cols);
+}
 
-    return NO_ERROR;
+// Helper: hang each leaf at the end of its canonical code. The (leaf, length)
+// pairs must satisfy Kraft's equality (a full tree), as Huffman and
+// package-merge lengths do.
+TreeNode* HuffmanTree::buildCanonicalShape(std::vector<std::pair<TreeNode*,int>>& leaves, NodeArena& arena) {
+    // Canonical order: shorter codes first, words alphabetical within a length
+    std::ranges::sort(leaves, [](const auto& a, const auto& b) {
+        if (a.second != b.second) return a.second < b.second;
+        return a.first->key_word < b.first->key_word;
+    });
+
+    // Hand out codes by counting up, shifting left whenever the length grows,
+    // and hang each leaf at the end of its code's path.
+    TreeNode* root = arena.make("");
+    root->freq = 0;
+    std::uint64_t code = 0;
+    int prevLength = leaves.front().second;
+    for (std::size_t i = 0; i < leaves.size(); ++i) {
+        auto [leaf, length] = leaves[i];
+        if (i > 0) {
+            code = (code + 1) << (length - prevLength);
+        }
+        prevLength = length;
+
+        TreeNode* node = root;
+        node->freq += leaf->freq;
+        for (int d = length - 1; d > 0; --d) {
+            TreeNode*& child = ((code >> d) & 1) ? node->right : node->left;
+            if (child == nullptr) {
+                child = arena.make("");
+                child->freq = 0;
+            }
+            node = child;
+            node->freq += leaf->freq;
+        }
+        ((code & 1) ? node->right : node->left) = leaf;
+    }
+    return root;
 }
 
-// Helper: destroy the entire tree
-void HuffmanTree::destroy(TreeNode* n) noexcept {
-    if(n == nullptr) {
+// Helper: collect (leaf, depth) pairs
+void HuffmanTree::collectLeaves(TreeNode* n, int depth,
+                                std::vector<std::pair<TreeNode*,int>>& out) {
+    if (n == nullptr) {
         return;
     }
-    
-    destroy(n->left);
-    destroy(n->right);
-    delete n;
+    if (n->left == nullptr && n->right == nullptr) {
+        out.emplace_back(n, depth);
+        return;
+    }
+    collectLeaves(n->left, depth + 1, out);
+    collectLeaves(n->right, depth + 1, out);
 }
 
 // Helper: DFS traversal to assign codes
@@ -193,3 +954,46 @@ void HuffmanTree::writeHeaderPreorder(const TreeNode* n, std::ostream& os,
         prefix.pop_back(); // backtrack
     }
 }
+
+// Helper: DFS like assignCodesDFS, storing each leaf's code at its rank
+void HuffmanTree::codeTableDFS(const TreeNode* n, std::string& prefix,
+                               std::vector<std::string>& codes) {
+    if (n == nullptr) {
+        return;
+    }
+    if (n->left == nullptr && n->right == nullptr) {
+        const auto symbol = static_cast<std::size_t>(n->rank);
+        if (codes.size() <= symbol) {
+            codes.resize(symbol + 1);
+        }
+        codes[symbol] = prefix.empty() ? "0" : prefix; // single-word edge case
+        return;
+    }
+    prefix.push_back('0');
+    codeTableDFS(n->left, prefix, codes);
+    prefix.back() = '1';
+    codeTableDFS(n->right, prefix, codes);
+    prefix.pop_back();
+}
+
+// Helper: the same walk with the code kept as an integer; false once a code
+// would not fit in BitCode::MAX_LENGTH bits
+bool HuffmanTree::codeTableDFS(const TreeNode* n, std::uint64_t bits, int depth,
+                               std::vector<BitCode>& codes) {
+    if (n == nullptr) {
+        return true;
+    }
+    if (n->left == nullptr && n->right == nullptr) {
+        const auto symbol = static_cast<std::size_t>(n->rank);
+        if (codes.size() <= symbol) {
+            codes.resize(symbol + 1);
+        }
+        codes[symbol] = {bits, static_cast<std::uint8_t>(depth == 0 ? 1 : depth)}; // single word: "0"
+        return true;
+    }
+    if (depth == BitCode::MAX_LENGTH) {
+        return false;
+    }
+    return codeTableDFS(n->left, bits << 1, depth + 1, codes) &&
+           codeTableDFS(n->right, (bits << 1) | 1, depth + 1, codes);
+}
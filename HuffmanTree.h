@@ -6,27 +6,101 @@
 #define HUFFMANTREE_H
 
 #pragma once
+#include <cstdint>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <utility> // std::pair
+#include <istream>
 #include <ostream>
 #include "TreeNode.h"
 #include "utils.hpp"
+#include "BitStream.h"
+#include "NodeArena.h"
+
+class ThreadPool;
+
+// How buildFromCounts pairs up the two lowest-frequency nodes.
+//   TWO_QUEUE - sort the leaves once, then merge from two FIFO queues in O(N)
+//               (merged nodes come out in nondecreasing order, so a queue suffices)
+//   HEAP      - binary-heap PriorityQueue, O(N log N)
+// Both break ties on integer ranks and produce the same tree.
+enum class MergeStrategy { TWO_QUEUE, HEAP };
+
+struct HuffmanBuildOptions {
+    MergeStrategy strategy = MergeStrategy::TWO_QUEUE;
+
+    // 0 = unbounded. Otherwise no code may be longer than this many bits:
+    // if the Huffman tree is deeper, optimal lengths under the limit are found
+    // with package-merge and the tree is rebuilt in canonical shape. Limits
+    // too small for the vocabulary (2^L < words) are raised to the minimum.
+    int maxCodeLength = 0;
+};
 
 class HuffmanTree {
 public:
     // Build from BST output (lexicographic vector of (word, count)).
-    static HuffmanTree buildFromCounts(const std::vector<std::pair<std::string,int>>& counts);
+    // Each word's position in that order is its rank; ties in frequency are
+    // broken on rank, and a merged node takes the smaller rank of its children.
+    static HuffmanTree buildFromCounts(const std::vector<std::pair<std::string,int>>& counts,
+                                       const HuffmanBuildOptions& options = {});
+
+    // Same, from counts indexed by symbol ID: freqs[i] is the count of
+    // words[i], and symbol i must be the i-th word in lexicographic order
+    // (the symbol is the leaf's rank). Leaves keep a copy of their word for
+    // the header; encode() then takes symbol IDs.
+    static HuffmanTree buildFromSymbolCounts(const std::vector<int>& freqs,
+                                             const std::vector<std::string_view>& words,
+                                             const HuffmanBuildOptions& options = {});
     
     HuffmanTree() = default;
-    ~HuffmanTree(); // deletes the entire Huffman tree
+    ~HuffmanTree() = default; // arena_ frees every node at once
+
+    // The tree owns its nodes: movable, not copyable.
+    HuffmanTree(const HuffmanTree&) = delete;
+    HuffmanTree& operator=(const HuffmanTree&) = delete;
+    HuffmanTree(HuffmanTree&& other) noexcept;
+    HuffmanTree& operator=(HuffmanTree&& other) noexcept;
     
     // Build a vector of (word, code) pairs by traversing the Huffman tree
     // (left=0, right=1; visit left before right).
     void assignCodes(std::vector<std::pair<std::string,std::string>>& out) const;
+
+    // Codes indexed by symbol: codes[i] is the code of the word with rank i.
+    void codeTable(std::vector<std::string>& codes) const;
+
+    // Same table as integers. Returns false if some code is longer than
+    // BitCode::MAX_LENGTH bits (needs a total count above ~10^13).
+    [[nodiscard]] bool codeTable(std::vector<BitCode>& codes) const;
     
+    // Longest code length in bits, and the total bits the counted tokens encode to.
+    [[nodiscard]] int maxCodeLength() const;
+    [[nodiscard]] std::uint64_t encodedBits() const;
+
+    // Reshape the tree so its codes are canonical: the code lengths stay the
+    // same, but codes are handed out in (length, word) order, counting up.
+    // A canonical code is fully described by its word list and lengths, so
+    // writeHeader() switches to the compact lengths-only header afterwards.
+    void makeCanonical();
+    [[nodiscard]] bool isCanonical() const noexcept;
+
     // Header writer (pre-order over leaves; "word<space>code"; newline at end).
+    // Canonical trees write the compact form instead:
+    //   #canonical
+    //   <number of 1-bit codes> <number of 2-bit codes> ... <number of max-length codes>
+    //   word            (one per line, in canonical order)
     error_type writeHeader(std::ostream& os) const;
+
+    // Write either header form from a (word, code) list in pre-order, as
+    // assignCodes() returns it.
+    static error_type writeCodebookHeader(std::ostream& os,
+                                          const std::vector<std::pair<std::string,std::string>>& codebook,
+                                          bool canonical);
+
+    // Header reader: parses either header form back into (word, code) pairs,
+    // in file order. Canonical codes are regenerated from the lengths.
+    static error_type readHeader(std::istream& is,
+                                 std::vector<std::pair<std::string,std::string>>& codebook);
     
     // Encode a sequence of tokens using the codebook derived from this tree.
     // Writes ASCII '0'/'1' and wraps lines to wrap_cols (80 by default).
@@ -34,16 +108,88 @@ public:
                       std::ostream& os_bits,
                       int wrap_cols = 80) const;
 
+    // Same as above, but lets the caller pick the output format.
+    // wrap_cols is only used by CodeFormat::ASCII.
+    error_type encode(const std::vector<std::string>& tokens,
+                      std::ostream& os_bits,
+                      CodeFormat format,
+                      int wrap_cols = 80) const;
+
+    // Encode symbol IDs (as numbered by buildFromSymbolCounts) through the
+    // symbol-indexed code table.
+    error_type encode(const std::vector<std::uint32_t>& symbols,
+                      std::ostream& os_bits,
+                      CodeFormat format,
+                      int wrap_cols = 80) const;
+
+    // Same output, encoded on 'pool': the stream is cut into chunks, a prefix
+    // sum of the chunks' bit lengths gives every chunk its exact bit offset,
+    // and the chunks are written in parallel. Bit-identical to encode().
+    error_type encode(const std::vector<std::uint32_t>& symbols,
+                      std::ostream& os_bits,
+                      CodeFormat format,
+                      ThreadPool& pool,
+                      int wrap_cols = 80) const;
+
+    // Encode symbol IDs with a code table indexed by symbol. The string form
+    // switches to integer codes whenever they all fit in a BitCode.
+    static error_type encodeWithTable(const std::vector<BitCode>& codes,
+                                      const std::vector<std::uint32_t>& symbols,
+                                      std::ostream& os_bits,
+                                      CodeFormat format,
+                                      int wrap_cols = 80);
+    static error_type encodeWithTable(const std::vector<BitCode>& codes,
+                                      const std::vector<std::uint32_t>& symbols,
+                                      std::ostream& os_bits,
+                                      CodeFormat format,
+                                      ThreadPool& pool,
+                                      int wrap_cols = 80);
+    static error_type encodeWithTable(const std::vector<std::string>& codes,
+                                      const std::vector<std::uint32_t>& symbols,
+                                      std::ostream& os_bits,
+                                      CodeFormat format,
+                                      int wrap_cols = 80);
+
+    // Same, but every 'escape' symbol (the ESCAPE_WORD's) is followed by the
+    // next of 'literals', spelled out with putLiteral(). Needs exactly one
+    // literal per escape; WORD_NOT_IN_CODEBOOK otherwise.
+    static error_type encodeWithEscapes(const std::vector<BitCode>& codes,
+                                        std::uint32_t escape,
+                                        const std::vector<std::uint32_t>& symbols,
+                                        const std::vector<std::string>& literals,
+                                        std::ostream& os_bits,
+                                        CodeFormat format,
+                                        int wrap_cols = 80);
+    static error_type encodeWithEscapes(const std::vector<std::string>& codes,
+                                        std::uint32_t escape,
+                                        const std::vector<std::uint32_t>& symbols,
+                                        const std::vector<std::string>& literals,
+                                        std::ostream& os_bits,
+                                        CodeFormat format,
+                                        int wrap_cols = 80);
+
 private:
-    TreeNode* root_ = nullptr; // owns the full Huffman tree
+    friend class FlatHuffmanTree; // copies the pointer tree's shape
+    TreeNode* root_ = nullptr; // top of the tree; the nodes live in arena_
+    bool canonical_ = false;   // set by makeCanonical()
+    NodeArena arena_;          // owns every node, including ones a rebuild left behind
     
     // helpers (decl only; defs in .cpp)
-    static void destroy(TreeNode* n) noexcept;
+    static HuffmanTree buildUnbounded(const std::vector<int>& freqs,
+                                      const std::vector<std::string_view>& words,
+                                      MergeStrategy strategy);
+    static TreeNode* buildCanonicalShape(std::vector<std::pair<TreeNode*,int>>& leaves, NodeArena& arena);
     static void assignCodesDFS(const TreeNode* n,
                                std::string& prefix,
                                std::vector<std::pair<std::string,std::string>>& out);
+    static void codeTableDFS(const TreeNode* n, std::string& prefix,
+                             std::vector<std::string>& codes);
+    static bool codeTableDFS(const TreeNode* n, std::uint64_t bits, int depth,
+                             std::vector<BitCode>& codes);
     static void writeHeaderPreorder(const TreeNode* n, std::ostream& os,
                                    std::string& prefix);
+    static void collectLeaves(TreeNode* n, int depth,
+                              std::vector<std::pair<TreeNode*,int>>& out);
 };
 
 #endif //HUFFMANTREE_H
@@ -0,0 +1,113 @@
+#include "MappedFile.h"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data_(other.data_), size_(other.size_), mapped_(other.mapped_), buffer_(std::move(other.buffer_)) {
+    other.data_ = nullptr;
+    other.size_ = 0;
+    other.mapped_ = false;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        data_ = other.data_;
+        size_ = other.size_;
+        mapped_ = other.mapped_;
+        buffer_ = std::move(other.buffer_);
+        other.data_ = nullptr;
+        other.size_ = 0;
+        other.mapped_ = false;
+    }
+    return *this;
+}
+
+error_type MappedFile::open(const std::filesystem::path& path) {
+    close();
+
+#ifdef HAVE_MMAP
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return UNABLE_TO_OPEN_FILE;
+    }
+    struct stat st {};
+    if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+        void* p = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            ::madvise(p, static_cast<std::size_t>(st.st_size), MADV_SEQUENTIAL); // read-ahead hint
+            ::close(fd);
+            data_ = static_cast<const char*>(p);
+            size_ = static_cast<std::size_t>(st.st_size);
+            mapped_ = true;
+            return NO_ERROR;
+        }
+    }
+    ::close(fd);
+    // Empty file, or mmap not possible (e.g. a pipe): fall through to reading
+#endif
+
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return UNABLE_TO_OPEN_FILE;
+    }
+    buffer_.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+    return NO_ERROR;
+}
+
+void MappedFile::close() noexcept {
+#ifdef HAVE_MMAP
+    if (mapped_) {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+    data_ = nullptr;
+    size_ = 0;
+    mapped_ = false;
+    buffer_.clear();
+}
+
+void MappedFile::release(std::size_t offset, std::size_t length) noexcept {
+#ifdef HAVE_MMAP
+    if (!mapped_ || offset >= size_) {
+        return;
+    }
+    length = std::min(length, size_ - offset);
+
+    // madvise works on whole pages: shrink the range to the pages it covers
+    // completely (mmap returned a page-aligned start)
+    const auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    const std::size_t first = (offset + page - 1) / page * page;
+    const std::size_t last = offset + length == size_ ? offset + length : (offset + length) / page * page;
+    if (last > first) {
+        ::madvise(const_cast<char*>(data_) + first, last - first, MADV_DONTNEED);
+    }
+#else
+    (void)offset;
+    (void)length;
+#endif
+}
+
+std::string_view MappedFile::view() const noexcept {
+    return {data_, size_};
+}
+
+std::size_t MappedFile::size() const noexcept {
+    return size_;
+}
@@ -0,0 +1,44 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#pragma once
+#include <cstddef>
+#include <filesystem>
+#include <string_view>
+#include <vector>
+#include "utils.hpp"
+
+// Read-only view of a whole file. On POSIX systems the file is memory-mapped
+// (no copy, pages come straight from the page cache); elsewhere, or if mmap
+// fails, the file is read into one buffer instead.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    // Map 'path'; any previously opened file is released first.
+    error_type open(const std::filesystem::path& path);
+    void close() noexcept;
+
+    // Hint that bytes [offset, offset + length) will not be read again. Mapped
+    // pages wholly inside the range are dropped from the process's memory
+    // (they come back from the file if touched), so a front-to-back reader's
+    // resident set stays bounded. No-op for the read() fallback.
+    void release(std::size_t offset, std::size_t length) noexcept;
+
+    [[nodiscard]] std::string_view view() const noexcept;
+    [[nodiscard]] std::size_t size() const noexcept;
+
+private:
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+    bool mapped_ = false;          // data_ comes from mmap (else from buffer_)
+    std::vector<char> buffer_;     // fallback storage
+};
+
+#endif //MAPPEDFILE_H
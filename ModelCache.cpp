@@ -0,0 +1,106 @@
+#include "ModelCache.h"
+#include <charconv>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "Hash.h"
+#include "MappedFile.h"
+
+namespace {
+
+constexpr const char* MAGIC = "#huffman-cache 1";
+
+const char* formatName(CodeFormat format) {
+    switch (format) {
+        case CodeFormat::BINARY: return "binary";
+        case CodeFormat::BLOCKED: return "blocked";
+        default: return "ascii";
+    }
+}
+
+bool parseFormat(const std::string& name, CodeFormat& format) {
+    if (name == "ascii") format = CodeFormat::ASCII;
+    else if (name == "binary") format = CodeFormat::BINARY;
+    else if (name == "blocked") format = CodeFormat::BLOCKED;
+    else return false;
+    return true;
+}
+
+} // End of namespace
+
+bool readCacheEntry(const std::filesystem::path& path, CacheEntry& entry) {
+    std::ifstream in(path);
+    std::string line;
+    if (!in || !std::getline(in, line) || line != MAGIC) {
+        return false;
+    }
+    entry = CacheEntry{};
+    int seen = 0; // one bit per required line
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string key;
+        fields >> key >> std::hex;
+        if (key == "input" && fields >> entry.inputHash >> std::dec >> entry.inputBytes) {
+            seen |= 1;
+        } else if (key == "model" && fields >> std::dec >> entry.canonical >> entry.maxCodeLength) {
+            seen |= 2;
+        } else if (key == "freq" && fields >> entry.freqHash) {
+            seen |= 4;
+        } else if (key == "hdr" && fields >> entry.hdrHash) {
+            seen |= 8;
+        } else if (key == "tokens") {
+            std::string value;
+            fields >> value;
+            entry.hasTokens = value != "-";
+            if (!entry.hasTokens) {
+                seen |= 16;
+            } else if (const auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(),
+                                                              entry.tokensHash, 16);
+                       ec == std::errc{} && end == value.data() + value.size()) {
+                seen |= 16;
+            }
+        } else if (key == "code") {
+            std::string format;
+            if (fields >> format >> entry.codeHash && parseFormat(format, entry.codeFormat)) {
+                seen |= 32;
+            }
+        }
+    }
+    return seen == 63;
+}
+
+error_type writeCacheEntry(const std::filesystem::path& path, const CacheEntry& entry) {
+    if (error_type st = canOpenForWriting(path.string()); st != NO_ERROR) {
+        return st;
+    }
+    std::ofstream out(path);
+    out << MAGIC << "\n" << std::hex
+        << "input " << entry.inputHash << std::dec << " " << entry.inputBytes << "\n"
+        << "model " << entry.canonical << " " << entry.maxCodeLength << "\n" << std::hex
+        << "freq " << entry.freqHash << "\n"
+        << "hdr " << entry.hdrHash << "\n";
+    if (entry.hasTokens) {
+        out << "tokens " << entry.tokensHash << "\n";
+    } else {
+        out << "tokens -\n";
+    }
+    out << "code " << formatName(entry.codeFormat) << " " << entry.codeHash << "\n";
+    return out ? NO_ERROR : FAILED_TO_WRITE_FILE;
+}
+
+bool hashFile(const std::filesystem::path& path, std::uint64_t& hash, std::uint64_t* bytes) {
+    MappedFile file;
+    if (file.open(path) != NO_ERROR) {
+        return false;
+    }
+    hash = xxHash64(file.view());
+    if (bytes != nullptr) {
+        *bytes = file.size();
+    }
+    return true;
+}
+
+bool fileMatches(const std::filesystem::path& path, std::uint64_t hash) {
+    std::uint64_t actual = 0;
+    return hashFile(path, actual) && actual == hash;
+}
@@ -0,0 +1,46 @@
+#ifndef MODELCACHE_H
+#define MODELCACHE_H
+
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include "BitStream.h"
+
+// What a --cache run records in <base>.meta next to its outputs: the input's
+// xxHash64 and size, the options the model and the .code depend on, and the
+// hash of every file it wrote. A later run with the same input and options
+// can then trust those files as long as their hashes still match, so
+// nothing is rebuilt for outputs another run has since replaced.
+//
+// <base>.meta is text, one "key value..." line each:
+//   #huffman-cache 1
+//   input <hash> <bytes>
+//   model <canonical 0|1> <max code length>
+//   freq <hash>
+//   hdr <hash>
+//   tokens <hash>            ("-" if no .tokens was written)
+//   code <format> <hash>
+struct CacheEntry {
+    std::uint64_t inputHash = 0;
+    std::uint64_t inputBytes = 0;
+    bool canonical = false;
+    int maxCodeLength = 0;
+    std::uint64_t freqHash = 0;
+    std::uint64_t hdrHash = 0;
+    bool hasTokens = false;
+    std::uint64_t tokensHash = 0;
+    CodeFormat codeFormat = CodeFormat::ASCII;
+    std::uint64_t codeHash = 0;
+};
+
+// False if 'path' is missing or not a cache file of this version.
+bool readCacheEntry(const std::filesystem::path& path, CacheEntry& entry);
+error_type writeCacheEntry(const std::filesystem::path& path, const CacheEntry& entry);
+
+// xxHash64 of a whole file (memory-mapped). False if it cannot be read.
+bool hashFile(const std::filesystem::path& path, std::uint64_t& hash, std::uint64_t* bytes = nullptr);
+
+// True if 'path' exists and hashes to 'hash'.
+bool fileMatches(const std::filesystem::path& path, std::uint64_t hash);
+
+#endif //MODELCACHE_H
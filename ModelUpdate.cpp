@@ -0,0 +1,100 @@
+#include "ModelUpdate.h"
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <climits>
+#include <cmath>
+#include <fstream>
+#include <string_view>
+#include <unordered_map>
+#include "BitStream.h"
+
+error_type readFreqFile(const std::filesystem::path& path, WordCounts& counts) {
+    std::ifstream in(path);
+    if (!in) {
+        return UNABLE_TO_OPEN_FILE;
+    }
+    counts.clear();
+    std::string line;
+    while (std::getline(in, line)) {
+        const std::size_t digits = line.find_first_not_of(' ');
+        const std::size_t space = line.find(' ', digits);
+        if (digits == std::string::npos || space == std::string::npos || space + 1 == line.size() ||
+            line[digits] < '0' || line[digits] > '9') {
+            return INVALID_FREQ_FILE;
+        }
+        int count = 0;
+        const char* end = line.data() + space;
+        if (const auto [ptr, ec] = std::from_chars(line.data() + digits, end, count);
+            ec != std::errc{} || ptr != end) {
+            return INVALID_FREQ_FILE; // not all digits, or past INT_MAX
+        }
+        counts.emplace_back(line.substr(space + 1), count);
+    }
+    std::ranges::sort(counts);
+    return NO_ERROR;
+}
+
+error_type mergeCounts(const WordCounts& base, const WordCounts& delta, WordCounts& merged) {
+    merged.clear();
+    merged.reserve(base.size() + delta.size());
+    auto a = base.begin();
+    auto b = delta.begin();
+    while (a != base.end() && b != delta.end()) {
+        if (a->first < b->first) {
+            merged.push_back(*a++);
+        } else if (b->first < a->first) {
+            merged.push_back(*b++);
+        } else {
+            if (a->second > INT_MAX - b->second) {
+                return INVALID_FREQ_FILE;
+            }
+            merged.emplace_back(a->first, a->second + b->second);
+            ++a;
+            ++b;
+        }
+    }
+    merged.insert(merged.end(), a, base.end());
+    merged.insert(merged.end(), b, delta.end());
+    return NO_ERROR;
+}
+
+double entropyBits(const WordCounts& counts) {
+    double total = 0;
+    for (const auto& [word, count] : counts) {
+        total += count;
+    }
+    double bits = 0;
+    for (const auto& [word, count] : counts) {
+        if (count > 0) {
+            bits += count * std::log2(total / count);
+        }
+    }
+    return bits;
+}
+
+CodingCost codingCost(const WordCounts& counts,
+                      const std::vector<std::pair<std::string, std::string>>& codebook) {
+    std::unordered_map<std::string_view, std::size_t> lengthOf;
+    lengthOf.reserve(codebook.size());
+    for (const auto& [word, code] : codebook) {
+        lengthOf.emplace(word, code.size());
+    }
+    const auto escape = lengthOf.find(ESCAPE_WORD);
+
+    CodingCost cost;
+    for (const auto& [word, count] : counts) {
+        const auto count64 = static_cast<std::uint64_t>(count);
+        if (const auto it = lengthOf.find(word); it != lengthOf.end()) {
+            cost.bits += count64 * it->second;
+        } else if (escape != lengthOf.end()) {
+            // Escape code, Elias-gamma length, 8 bits per character (see putLiteral)
+            const std::uint64_t literal = 2 * std::bit_width(word.size() + 1) - 1 + 8 * word.size();
+            cost.bits += count64 * (escape->second + literal);
+            ++cost.escapedWords;
+        } else {
+            ++cost.uncodedWords;
+        }
+    }
+    return cost;
+}
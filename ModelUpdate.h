@@ -0,0 +1,40 @@
+#ifndef MODELUPDATE_H
+#define MODELUPDATE_H
+
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+#include "utils.hpp"
+
+// (word, count) pairs in lexicographic order, as inorderCollect() produces
+// and buildFromCounts() takes.
+using WordCounts = std::vector<std::pair<std::string, int>>;
+
+// Read a .freq file (a right-aligned count, one space, the word) back into
+// lexicographic (word, count) pairs. INVALID_FREQ_FILE on a malformed line or
+// a count that does not fit an int.
+error_type readFreqFile(const std::filesystem::path& path, WordCounts& counts);
+
+// One table holding both: counts of words in both are added. Linear, since
+// both inputs are sorted. INVALID_FREQ_FILE if a sum does not fit an int.
+error_type mergeCounts(const WordCounts& base, const WordCounts& delta, WordCounts& merged);
+
+// Shannon entropy of the counts, in total bits: sum of c * log2(total / c).
+// No prefix code can do better.
+double entropyBits(const WordCounts& counts);
+
+// What coding 'counts' with an existing codebook costs. A word without a
+// code goes out as the ESCAPE_WORD plus its literal if the codebook has an
+// escape; otherwise it cannot be coded and only 'uncoded' counts it.
+struct CodingCost {
+    std::uint64_t bits = 0;
+    std::size_t escapedWords = 0;   // distinct words sent as literals
+    std::size_t uncodedWords = 0;   // distinct words with no code and no escape
+};
+CodingCost codingCost(const WordCounts& counts,
+                      const std::vector<std::pair<std::string, std::string>>& codebook);
+
+#endif //MODELUPDATE_H
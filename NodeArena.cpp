@@ -0,0 +1,88 @@
+#include "NodeArena.h"
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <string>
+#include <utility>
+
+namespace {
+
+std::atomic<std::uint64_t> blockAllocations{0};
+
+// Capacity of an empty std::string: anything larger lives on the heap
+const std::size_t INLINE_CAPACITY = std::string().capacity();
+
+} // End of namespace
+
+NodeArena::NodeArena(std::size_t firstBlockNodes)
+    : nextBlockNodes_(std::clamp<std::size_t>(firstBlockNodes, 1, MAX_BLOCK_NODES)) {}
+
+NodeArena::~NodeArena() {
+    release();
+}
+
+NodeArena::NodeArena(NodeArena&& other) noexcept
+    : blocks_(std::move(other.blocks_)), ownsHeap_(std::move(other.ownsHeap_)),
+      nextBlockNodes_(other.nextBlockNodes_), next_(other.next_), left_(other.left_), nodes_(other.nodes_) {
+    other.next_ = nullptr;
+    other.left_ = 0;
+    other.nodes_ = 0;
+}
+
+NodeArena& NodeArena::operator=(NodeArena&& other) noexcept {
+    if (this != &other) {
+        release();
+        blocks_ = std::move(other.blocks_);
+        ownsHeap_ = std::move(other.ownsHeap_);
+        nextBlockNodes_ = other.nextBlockNodes_;
+        next_ = other.next_;
+        left_ = other.left_;
+        nodes_ = other.nodes_;
+        other.next_ = nullptr;
+        other.left_ = 0;
+        other.nodes_ = 0;
+    }
+    return *this;
+}
+
+TreeNode* NodeArena::make(std::string_view word) {
+    if (left_ == 0) {
+        blocks_.push_back(std::make_unique<Slot[]>(nextBlockNodes_));
+        blockAllocations.fetch_add(1, std::memory_order_relaxed);
+        next_ = blocks_.back().get();
+        left_ = nextBlockNodes_;
+        nextBlockNodes_ = std::min(nextBlockNodes_ * 2, MAX_BLOCK_NODES);
+    }
+    TreeNode* node = ::new (static_cast<void*>(next_)) TreeNode(word);
+    ++next_;
+    --left_;
+    ++nodes_;
+    if (node->key_word.capacity() > INLINE_CAPACITY) {
+        ownsHeap_.push_back(node);
+    }
+    return node;
+}
+
+void NodeArena::release() noexcept {
+    // Nodes never change their word after make(), so only these own memory
+    for (TreeNode* node : ownsHeap_) {
+        node->~TreeNode();
+    }
+    ownsHeap_.clear();
+    blocks_.clear();
+    next_ = nullptr;
+    left_ = 0;
+    nodes_ = 0;
+}
+
+std::size_t NodeArena::nodeCount() const noexcept {
+    return nodes_;
+}
+
+std::size_t NodeArena::blockCount() const noexcept {
+    return blocks_.size();
+}
+
+std::uint64_t NodeArena::totalBlockAllocations() noexcept {
+    return blockAllocations.load(std::memory_order_relaxed);
+}
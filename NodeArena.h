@@ -0,0 +1,56 @@
+#ifndef NODEARENA_H
+#define NODEARENA_H
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+#include "TreeNode.h"
+
+// Bump allocator for TreeNodes. Nodes are placed into large blocks (each one
+// twice the size of the last, up to MAX_BLOCK_NODES), are never freed one by
+// one, and all go away together when the arena is released or destroyed.
+//
+// Release does not walk the nodes: a word short enough for std::string's
+// inline buffer owns no memory, so only the (rare) nodes whose word spilled to
+// the heap are remembered and destroyed; the blocks are then freed whole.
+class NodeArena {
+public:
+    explicit NodeArena(std::size_t firstBlockNodes = 256);
+    ~NodeArena(); // release()
+
+    NodeArena(const NodeArena&) = delete;
+    NodeArena& operator=(const NodeArena&) = delete;
+    NodeArena(NodeArena&& other) noexcept;
+    NodeArena& operator=(NodeArena&& other) noexcept;
+
+    // A new node holding a copy of 'word' (freq 1, no children), as new TreeNode(word) would.
+    TreeNode* make(std::string_view word);
+
+    // Free every node made so far; pointers to them become invalid.
+    void release() noexcept;
+
+    [[nodiscard]] std::size_t nodeCount() const noexcept;
+    [[nodiscard]] std::size_t blockCount() const noexcept;
+
+    // Instrumentation: blocks allocated by every arena in the process so far.
+    // With one heap allocation per block, this is the arenas' allocation count.
+    static std::uint64_t totalBlockAllocations() noexcept;
+
+    static constexpr std::size_t MAX_BLOCK_NODES = 1 << 16;
+
+private:
+    struct alignas(TreeNode) Slot {
+        std::byte bytes[sizeof(TreeNode)];
+    };
+    std::vector<std::unique_ptr<Slot[]>> blocks_;
+    std::vector<TreeNode*> ownsHeap_;   // nodes whose key_word allocated
+    std::size_t nextBlockNodes_;
+    Slot* next_ = nullptr;              // free slots in the newest block
+    std::size_t left_ = 0;
+    std::size_t nodes_ = 0;
+};
+
+#endif //NODEARENA_H
@@ -0,0 +1,1397 @@
+#include "Pipeline.h"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <climits> // For INT_MAX
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "AdaptiveHuffman.h"
+#include "BinSearchTree.h"
+#include "BlockCode.h"
+#include "FlatHuffmanTree.h"
+#include "HuffmanDecoder.h"
+#include "HuffmanTree.h"
+#include "ModelCache.h"
+#include "ModelUpdate.h"
+#include "Scanner.hpp"
+#include "StringInterner.h"
+#include "ThreadPool.h"
+#include "utils.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define HAVE_POSIX_READ 1
+#include <cerrno>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Buffered "one word per line" writer for .tokens (memory stays at the buffer size)
+class LineWriter {
+public:
+    explicit LineWriter(const fs::path& path) : out_(path, std::ios::binary) {
+        buffer_.reserve(BUFFER_BYTES);
+    }
+
+    [[nodiscard]] bool isOpen() const { return out_.is_open(); }
+
+    void add(std::string_view word) {
+        buffer_ += word;
+        buffer_ += '\n';
+        if (buffer_.size() >= BUFFER_BYTES - 64) {
+            flush();
+        }
+    }
+
+    error_type finish() {
+        flush();
+        return out_ ? NO_ERROR : FAILED_TO_WRITE_FILE;
+    }
+
+private:
+    static constexpr std::size_t BUFFER_BYTES = 1 << 16;
+    std::ofstream out_;
+    std::string buffer_;
+
+    void flush() {
+        out_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+        buffer_.clear();
+    }
+};
+
+// One token per line, each word written from the interner (the only place
+// the token stream turns back into text)
+error_type writeTokens(const fs::path& path, const std::vector<std::uint32_t>& ids,
+                       const StringInterner& interner) {
+    LineWriter out(path);
+    if (!out.isOpen()) {
+        return UNABLE_TO_OPEN_FILE_FOR_WRITING;
+    }
+    for (std::uint32_t id : ids) {
+        out.add(interner.word(id));
+    }
+    return out.finish();
+}
+
+// Number the interned words in lexicographic order (the symbol numbering the
+// tree uses for tie-breaks): symbolOf[id], plus words and counts per symbol
+void symbolize(const StringInterner& interner, const std::vector<int>& countOf,
+               std::vector<std::uint32_t>& symbolOf, std::vector<std::string_view>& words,
+               std::vector<int>& freqs) {
+    std::vector<std::uint32_t> order(interner.size());
+    for (std::size_t i = 0; i < order.size(); ++i) order[i] = static_cast<std::uint32_t>(i);
+    std::ranges::sort(order, [&interner](std::uint32_t a, std::uint32_t b) {
+        return interner.word(a) < interner.word(b);
+    });
+    symbolOf.resize(order.size());
+    words.resize(order.size());
+    freqs.resize(order.size());
+    for (std::size_t s = 0; s < order.size(); ++s) {
+        symbolOf[order[s]] = static_cast<std::uint32_t>(s);
+        words[s] = interner.word(order[s]);
+        freqs[s] = countOf[order[s]];
+    }
+}
+
+// Total tokens and min/max frequency (the part of the report every counter shares)
+void reportTotals(std::ostream& report, std::size_t totalTokens, const std::vector<int>& freqs) {
+    // frequency
+    int minFreq = INT_MAX;
+    int maxFreq = 0;
+
+    // Calculate min and max frequency
+    for (int freq : freqs) {
+        minFreq = std::min(minFreq, freq);
+        maxFreq = std::max(maxFreq, freq);
+    }
+    report << "Total tokens: " << totalTokens << "\n";
+    report << "Min frequency: " << minFreq << "\n";
+    report << "Max frequency: " << maxFreq << "\n";
+}
+
+// The compression steps below stop at the first error and return it, with
+// the file it concerns in 'failedOn': compressFile() exits on it, a batch
+// reports it and carries on with the other files
+error_type failed(error_type st, const fs::path& path, std::string& failedOn) {
+    failedOn = path.string();
+    return st;
+}
+
+// Write <base>.freq (sorted by count desc, word asc). 'words' is in
+// lexicographic order, so the symbol index breaks ties alphabetically.
+error_type writeFreq(const fs::path& freqPath, const std::vector<std::string_view>& words,
+                     const std::vector<int>& freqs, std::string& failedOn) {
+    if (error_type st; (st = canOpenForWriting(freqPath.string())) != NO_ERROR)
+        return failed(st, freqPath, failedOn);
+
+    std::vector<std::uint32_t> sorted(freqs.size());
+    for (std::size_t i = 0; i < sorted.size(); ++i) sorted[i] = static_cast<std::uint32_t>(i);
+    std::ranges::sort(sorted, [&freqs](std::uint32_t a, std::uint32_t b) {
+        if (freqs[a] != freqs[b]) return freqs[a] > freqs[b]; // higher count first
+        return a < b;                                         // alphabetical on ties
+    });
+
+    std::ofstream freqOut(freqPath);
+    for (std::uint32_t s : sorted) {
+        freqOut << std::setw(10) << freqs[s] << ' ' << words[s] << '\n';  // exactly one space
+    }
+    if (!freqOut)
+        return failed(FAILED_TO_WRITE_FILE, freqPath, failedOn);
+    return NO_ERROR;
+}
+
+// Build the Huffman tree (plus the --max-code-length cost report).
+// 'Tree' is HuffmanTree or FlatHuffmanTree.
+template <typename Tree>
+Tree buildTree(const std::vector<int>& freqs, const std::vector<std::string_view>& words,
+               const PipelineOptions& options, std::ostream& report) {
+    ScopedStage stage(options.stats, "tree build");
+    stage.distinct(freqs.size());
+    Tree tree = Tree::buildFromSymbolCounts(freqs, words, {.maxCodeLength = options.maxCodeLength});
+    if (options.maxCodeLength > 0) {
+        // Compression cost of the limit, against the unbounded Huffman tree
+        const Tree unbounded = Tree::buildFromSymbolCounts(freqs, words);
+        const std::uint64_t limitedBits = tree.encodedBits();
+        const std::uint64_t optimalBits = unbounded.encodedBits();
+        report << "Max code length: " << tree.maxCodeLength() << " bits (requested limit " << options.maxCodeLength
+               << ", unbounded " << unbounded.maxCodeLength() << ")\n";
+        report << "Encoded bits: " << limitedBits << " limited vs " << optimalBits << " unbounded (+"
+               << std::fixed << std::setprecision(3)
+               << (optimalBits ? 100.0 * static_cast<double>(limitedBits - optimalBits) / static_cast<double>(optimalBits) : 0.0)
+               << "%)\n" << std::defaultfloat;
+    }
+    if (options.canonical) {
+        tree.makeCanonical(); // same code lengths, so same .code size
+    }
+    return tree;
+}
+
+// Write <base>.hdr for 'tree' as one stage
+template <typename Tree>
+error_type writeHeaderStage(const fs::path& hdrPath, const Tree& tree, std::size_t distinct,
+                            PipelineStats* stats, std::string& failedOn) {
+    ScopedStage stage(stats, "header write");
+    stage.distinct(distinct);
+    if (error_type st; (st = canOpenForWriting(hdrPath.string())) != NO_ERROR)
+        return failed(st, hdrPath, failedOn);
+    {
+        std::ofstream hdrOut(hdrPath);
+        if (tree.writeHeader(hdrOut) != NO_ERROR || !hdrOut)
+            return failed(FAILED_TO_WRITE_FILE, hdrPath, failedOn);
+    }
+    stage.bytesOutFile(hdrPath);
+    return NO_ERROR;
+}
+
+// writeFreq() as one stage
+error_type writeFreqStage(const fs::path& freqPath, const std::vector<std::string_view>& words,
+                          const std::vector<int>& freqs, PipelineStats* stats, std::string& failedOn) {
+    ScopedStage stage(stats, "freq write");
+    stage.distinct(words.size());
+    if (error_type st = writeFreq(freqPath, words, freqs, failedOn); st != NO_ERROR) {
+        return st;
+    }
+    stage.bytesOutFile(freqPath);
+    return NO_ERROR;
+}
+
+// Input size for the scan stages (only asked for under --stats)
+std::uint64_t inputBytes(const fs::path& inPath, const PipelineStats* stats) {
+    std::error_code ec;
+    return stats != nullptr ? fs::file_size(inPath, ec) : 0;
+}
+
+// Open <base>.code and run 'encode' on it
+template <typename Encode>
+error_type writeCode(const fs::path& codePath, Encode&& encode, std::string& failedOn) {
+    if (error_type st; (st = canOpenForWriting(codePath.string())) != NO_ERROR)
+        return failed(st, codePath, failedOn);
+    std::ofstream codeOut(codePath, std::ios::binary);
+    const error_type st = encode(codeOut);
+    if (st != NO_ERROR || !codeOut)
+        return failed(st == NO_ERROR ? FAILED_TO_WRITE_FILE : st, codePath, failedOn);
+    return NO_ERROR;
+}
+
+// Scan -> word IDs -> per-ID counts -> symbols in lexicographic order -> tree -> encode
+error_type runInterned(const fs::path& inPath, const fs::path& dir, const std::string& base,
+                       const PipelineOptions& options, std::ostream& report, std::string& failedOn) {
+    const fs::path tokensPath = dir / (base + ".tokens");
+
+    // Scanning: one ID per token, one stored string per distinct word
+    std::vector<std::uint32_t> ids;
+    StringInterner interner;
+    Scanner scanner(inPath);
+    error_type st;
+    std::unique_ptr<ThreadPool> ownPool;
+    ThreadPool* pool = options.pool; // shared by scanning and encoding
+    if (pool == nullptr && options.threads != 1) {
+        ownPool = std::make_unique<ThreadPool>(static_cast<unsigned>(options.threads));
+        pool = ownPool.get();
+    }
+    {
+        ScopedStage stage(options.stats, "scan");
+        stage.bytesIn(inputBytes(inPath, options.stats));
+        st = pool ? scanner.tokenize(ids, interner, *pool) : scanner.tokenize(ids, interner);
+        stage.tokens(ids.size());
+        stage.distinct(interner.size());
+    }
+    if (st != NO_ERROR)
+        return failed(st, inPath, failedOn);
+    if (options.writeTokens) {
+        ScopedStage stage(options.stats, "tokens write");
+        stage.tokens(ids.size());
+        if ((st = writeTokens(tokensPath, ids, interner)) != NO_ERROR)
+            return failed(st, tokensPath, failedOn);
+        stage.bytesOutFile(tokensPath);
+    }
+
+    std::vector<std::uint32_t> symbolOf;
+    std::vector<std::string_view> words;
+    std::vector<int> freqs;
+    {
+        ScopedStage stage(options.stats, "count");
+        stage.tokens(ids.size());
+        stage.distinct(interner.size());
+
+        // Counting is one array increment per token
+        std::vector<int> countOf(interner.size(), 0);
+        for (std::uint32_t id : ids) {
+            countOf[id]++;
+        }
+
+        // Renumber IDs into lexicographic order, then rewrite the token stream in place
+        symbolize(interner, countOf, symbolOf, words, freqs);
+        for (std::uint32_t& id : ids) {
+            id = symbolOf[id];
+        }
+    }
+
+    // Print out results
+    report << "Unique words: " << words.size() << "\n";
+    reportTotals(report, ids.size(), freqs);
+
+    if ((st = writeFreqStage(dir / (base + ".freq"), words, freqs, options.stats, failedOn)) != NO_ERROR)
+        return st;
+    const fs::path hdrPath = dir / (base + ".hdr");
+    const fs::path codePath = dir / (base + ".code");
+    auto encodeWith = [&](const auto& tree) {
+        if ((st = writeHeaderStage(hdrPath, tree, words.size(), options.stats, failedOn)) != NO_ERROR)
+            return st;
+        ScopedStage stage(options.stats, "encode");
+        stage.tokens(ids.size());
+        stage.distinct(words.size());
+        st = writeCode(codePath, [&](std::ostream& os) {
+            return pool ? tree.encode(ids, os, options.codeFormat, *pool) : tree.encode(ids, os, options.codeFormat);
+        }, failedOn);
+        if (st == NO_ERROR)
+            stage.bytesOutFile(codePath);
+        return st;
+    };
+    if (options.layout == TreeLayout::FLAT) {
+        return encodeWith(buildTree<FlatHuffmanTree>(freqs, words, options, report));
+    }
+    return encodeWith(buildTree<HuffmanTree>(freqs, words, options, report));
+}
+
+// Pass 1 of the streaming pipeline: intern and count each token as it is
+// scanned (and optionally write it to .tokens); nothing per token is kept
+class CountingSink : public TokenSink {
+public:
+    CountingSink(StringInterner& interner, std::vector<int>& countOf, LineWriter* tokens)
+        : interner_(interner), countOf_(countOf), tokens_(tokens) {}
+
+    void token(std::string_view word) override {
+        const std::uint32_t id = interner_.intern(word);
+        if (id == countOf_.size()) {
+            countOf_.push_back(0);
+        }
+        countOf_[id]++;
+        ++total_;
+        if (tokens_ != nullptr) {
+            tokens_->add(word);
+        }
+    }
+
+    [[nodiscard]] std::size_t total() const noexcept { return total_; }
+
+private:
+    StringInterner& interner_;
+    std::vector<int>& countOf_;
+    LineWriter* tokens_;
+    std::size_t total_ = 0;
+};
+
+// Pass 2: look each token up again and send its code straight to the writer
+template <typename Writer, typename Code>
+class EncodingSink : public TokenSink {
+public:
+    EncodingSink(StringInterner& interner, const std::vector<Code>& codeOf, Writer& writer)
+        : interner_(interner), codeOf_(codeOf), writer_(writer) {}
+
+    void token(std::string_view word) override {
+        writer_.putBits(codeOf_[interner_.intern(word)]); // every word was seen in pass 1
+    }
+
+private:
+    StringInterner& interner_;
+    const std::vector<Code>& codeOf_;
+    Writer& writer_;
+};
+
+// Scan + count in one pass, tree, then re-scan and encode: memory follows the
+// vocabulary (interner, counts, code table), never the number of tokens
+error_type runStreaming(const fs::path& inPath, const fs::path& dir, const std::string& base,
+                        const PipelineOptions& options, std::ostream& report, std::string& failedOn) {
+    Scanner scanner(inPath);
+    StringInterner interner;
+    std::vector<int> countOf;
+
+    // Pass 1 (scan, count and .tokens are one stage here)
+    std::vector<std::uint32_t> symbolOf;
+    std::vector<std::string_view> words;
+    std::vector<int> freqs;
+    std::size_t totalTokens = 0;
+    {
+        ScopedStage stage(options.stats, "scan+count");
+        stage.bytesIn(inputBytes(inPath, options.stats));
+        std::unique_ptr<LineWriter> tokens;
+        if (options.writeTokens) {
+            tokens = std::make_unique<LineWriter>(dir / (base + ".tokens"));
+            if (!tokens->isOpen())
+                return failed(UNABLE_TO_OPEN_FILE_FOR_WRITING, dir / (base + ".tokens"), failedOn);
+        }
+        CountingSink counter(interner, countOf, tokens.get());
+        if (error_type st; (st = scanner.scan(counter)) != NO_ERROR)
+            return failed(st, inPath, failedOn);
+        if (tokens != nullptr && tokens->finish() != NO_ERROR)
+            return failed(FAILED_TO_WRITE_FILE, dir / (base + ".tokens"), failedOn);
+        tokens.reset();
+
+        symbolize(interner, countOf, symbolOf, words, freqs);
+        totalTokens = counter.total();
+        stage.tokens(totalTokens);
+        stage.distinct(words.size());
+        if (options.writeTokens) {
+            stage.bytesOutFile(dir / (base + ".tokens"));
+        }
+    }
+
+    // Print out results
+    report << "Unique words: " << words.size() << "\n";
+    reportTotals(report, totalTokens, freqs);
+
+    error_type st;
+    if ((st = writeFreqStage(dir / (base + ".freq"), words, freqs, options.stats, failedOn)) != NO_ERROR)
+        return st;
+    const fs::path hdrPath = dir / (base + ".hdr");
+    std::vector<std::string> codes;
+    auto headerAndCodes = [&](const auto& tree) {
+        tree.codeTable(codes);
+        return writeHeaderStage(hdrPath, tree, words.size(), options.stats, failedOn);
+    };
+    st = options.layout == TreeLayout::FLAT ? headerAndCodes(buildTree<FlatHuffmanTree>(freqs, words, options, report))
+                                            : headerAndCodes(buildTree<HuffmanTree>(freqs, words, options, report));
+    if (st != NO_ERROR)
+        return st;
+
+    // Pass 2, with codes by interner ID so no renumbering is needed
+    ScopedStage stage(options.stats, "encode");
+    stage.bytesIn(inputBytes(inPath, options.stats));
+    stage.tokens(totalTokens);
+    stage.distinct(words.size());
+    auto encodeAll = [&](const auto& codeOf) {
+        return writeCode(dir / (base + ".code"), [&](std::ostream& os) {
+            auto encodeWith = [&](auto& writer) {
+                EncodingSink sink(interner, codeOf, writer);
+                if (error_type st = scanner.scan(sink); st != NO_ERROR) {
+                    return st;
+                }
+                return writer.finish();
+            };
+            if (options.codeFormat == CodeFormat::BINARY) {
+                BitWriter writer(os);
+                return encodeWith(writer);
+            }
+            if (options.codeFormat == CodeFormat::BLOCKED) {
+                BlockWriter writer(os);
+                return encodeWith(writer);
+            }
+            TextBitWriter writer(os);
+            return encodeWith(writer);
+        }, failedOn);
+    };
+    if (std::ranges::all_of(codes, [](const std::string& c) { return c.size() <= BitCode::MAX_LENGTH; })) {
+        std::vector<BitCode> codeOf(codes.size());
+        for (std::size_t id = 0; id < codeOf.size(); ++id) {
+            codeOf[id] = BitCode::fromString(codes[symbolOf[id]]);
+        }
+        st = encodeAll(codeOf);
+    } else {
+        std::vector<std::string> codeOf(codes.size());
+        for (std::size_t id = 0; id < codeOf.size(); ++id) {
+            codeOf[id] = std::move(codes[symbolOf[id]]);
+        }
+        st = encodeAll(codeOf);
+    }
+    if (st == NO_ERROR)
+        stage.bytesOutFile(dir / (base + ".code"));
+    return st;
+}
+
+// The original string path, kept as the reference for benchmarks
+error_type runStrings(const fs::path& inPath, const fs::path& dir, const std::string& base,
+                      const PipelineOptions& options, std::ostream& report, std::string& failedOn) {
+    const fs::path tokensPath = dir / (base + ".tokens");
+
+    // Scanning and writing
+    std::vector<std::string> words;
+    Scanner scanner(inPath); // IMPORTANT: pass the INPUT .txt here
+
+    // Option A (keep your utils writer):
+    {
+        ScopedStage stage(options.stats, "scan");
+        stage.bytesIn(inputBytes(inPath, options.stats));
+        if (options.pool != nullptr) {
+            if (error_type st; (st = scanner.tokenize(words, *options.pool)) != NO_ERROR)
+                return failed(st, inPath, failedOn);
+        } else if (options.threads == 1) {
+            if (error_type st; (st = scanner.tokenize(words)) != NO_ERROR)
+                return failed(st, inPath, failedOn);
+        } else {
+            ThreadPool pool(static_cast<unsigned>(options.threads));
+            if (error_type st; (st = scanner.tokenize(words, pool)) != NO_ERROR)
+                return failed(st, inPath, failedOn);
+        }
+        stage.tokens(words.size());
+    }
+    {
+        ScopedStage stage(options.stats, "tokens write");
+        stage.tokens(words.size());
+        if (error_type st; (st = writeVectorToFile(tokensPath.string(), words)) != NO_ERROR)
+            return failed(st, tokensPath, failedOn);
+        stage.bytesOutFile(tokensPath);
+    }
+
+    // Part 2: read all tokens back from the .tokens file
+    std::vector<std::string> tokens; // holds tokens
+    {
+        ScopedStage stage(options.stats, "tokens read");
+        stage.bytesIn(inputBytes(tokensPath, options.stats));
+        std::ifstream inTokens(tokensPath);
+        std::string word;
+        while (inTokens >> word) {
+            tokens.push_back(word);
+        }
+        stage.tokens(tokens.size());
+    }
+
+    // Count with the selected engine (binary search tree by default)
+    std::unique_ptr<FrequencyCounter> counter = FrequencyCounter::create(options.counter);
+    std::vector<std::pair<std::string, int>> wordCounts;
+    std::vector<std::string_view> sortedWords;
+    std::vector<int> freqs;
+    {
+        ScopedStage stage(options.stats, "count");
+        stage.tokens(tokens.size());
+        counter->bulkAdd(tokens);
+
+        // In-order traversal to collect words and counts (sorted alphabetically)
+        counter->collect(wordCounts);
+
+        sortedWords.reserve(wordCounts.size());
+        freqs.reserve(wordCounts.size());
+        for (const auto& [w, c] : wordCounts) {
+            sortedWords.push_back(w);
+            freqs.push_back(c);
+        }
+        stage.distinct(sortedWords.size());
+    }
+
+    // Print out results
+    counter->printStats(report);
+    reportTotals(report, tokens.size(), freqs);
+
+    error_type st;
+    if ((st = writeFreqStage(dir / (base + ".freq"), sortedWords, freqs, options.stats, failedOn)) != NO_ERROR)
+        return st;
+    const auto tree = buildTree<HuffmanTree>(freqs, sortedWords, options, report);
+    if ((st = writeHeaderStage(dir / (base + ".hdr"), tree, sortedWords.size(), options.stats, failedOn)) != NO_ERROR)
+        return st;
+    ScopedStage stage(options.stats, "encode");
+    stage.tokens(words.size());
+    stage.distinct(sortedWords.size());
+    st = writeCode(dir / (base + ".code"), [&](std::ostream& os) {
+        return tree.encode(words, os, options.codeFormat);
+    }, failedOn);
+    if (st == NO_ERROR)
+        stage.bytesOutFile(dir / (base + ".code"));
+    return st;
+}
+
+error_type runPipeline(const fs::path& inPath, const fs::path& dir, const std::string& base,
+                       const PipelineOptions& options, std::ostream& report, std::string& failedOn) {
+    if (options.writeTokens || options.kind == PipelineKind::STRINGS) {
+        const fs::path tokensPath = dir / (base + ".tokens");
+        if (error_type st; (st = canOpenForWriting(tokensPath.string())) != NO_ERROR)
+            return failed(st, tokensPath, failedOn);
+    }
+    if (options.kind == PipelineKind::STRINGS) {
+        return runStrings(inPath, dir, base, options, report, failedOn);
+    }
+    if (options.kind == PipelineKind::STREAMING) {
+        return runStreaming(inPath, dir, base, options, report, failedOn);
+    }
+    return runInterned(inPath, dir, base, options, report, failedOn);
+}
+
+// Cache hit with a stale .code: number the header's words in file order,
+// scan the input into those numbers and encode with the header's codes.
+// 'encoded' is false (nothing written) if the input has a word the header lacks.
+error_type encodeWithHeader(const fs::path& inPath, const fs::path& hdrPath, const fs::path& codePath,
+                            const PipelineOptions& options, bool& encoded, std::string& failedOn) {
+    encoded = false;
+    std::vector<std::pair<std::string, std::string>> codebook;
+    std::ifstream hdrIn(hdrPath);
+    if (HuffmanTree::readHeader(hdrIn, codebook) != NO_ERROR) {
+        return NO_ERROR;
+    }
+    StringInterner interner;
+    std::vector<std::string> codes;
+    codes.reserve(codebook.size());
+    for (const auto& [word, code] : codebook) {
+        interner.intern(word);
+        codes.push_back(code);
+    }
+    if (interner.size() != codes.size()) {
+        return NO_ERROR; // a repeated word: not a header this program wrote
+    }
+
+    class SymbolSink : public TokenSink {
+    public:
+        SymbolSink(StringInterner& interner, std::size_t known) : interner_(interner), known_(known) {}
+        void token(std::string_view word) override {
+            const std::uint32_t id = interner_.intern(word);
+            missing |= id >= known_;
+            symbols.push_back(id);
+        }
+        std::vector<std::uint32_t> symbols;
+        bool missing = false;
+    private:
+        StringInterner& interner_;
+        std::size_t known_;
+    } sink(interner, codes.size());
+
+    {
+        ScopedStage stage(options.stats, "scan");
+        Scanner scanner(inPath);
+        if (error_type st; (st = scanner.scan(sink)) != NO_ERROR)
+            return failed(st, inPath, failedOn);
+        stage.tokens(sink.symbols.size());
+    }
+    if (sink.missing) {
+        return NO_ERROR;
+    }
+    ScopedStage stage(options.stats, "encode");
+    stage.tokens(sink.symbols.size());
+    const error_type st = writeCode(codePath, [&](std::ostream& os) {
+        return HuffmanTree::encodeWithTable(codes, sink.symbols, os, options.codeFormat);
+    }, failedOn);
+    if (st != NO_ERROR)
+        return st;
+    stage.bytesOutFile(codePath);
+    encoded = true;
+    return NO_ERROR;
+}
+
+// --cache: hash the input and compare with <base>.meta. Same input, same
+// model options and untouched outputs: with the .code current too there is
+// nothing to do; otherwise encode straight from <base>.hdr's code table.
+// Anything else is a full run that records a new <base>.meta.
+error_type compressCached(const fs::path& inPath, const fs::path& dir, const std::string& base,
+                          const PipelineOptions& options, std::ostream& report, std::string& failedOn) {
+    using Clock = std::chrono::steady_clock;
+    const auto start = Clock::now();
+    auto msSince = [](Clock::time_point from) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - from).count();
+    };
+    const fs::path metaPath = dir / (base + ".meta");
+    const fs::path tokensPath = dir / (base + ".tokens");
+    const fs::path freqPath = dir / (base + ".freq");
+    const fs::path hdrPath = dir / (base + ".hdr");
+    const fs::path codePath = dir / (base + ".code");
+
+    CacheEntry entry;
+    const bool known = readCacheEntry(metaPath, entry);
+    std::uint64_t inputHash = 0;
+    std::uint64_t inputBytes = 0;
+    {
+        ScopedStage stage(options.stats, "cache check");
+        if (!hashFile(inPath, inputHash, &inputBytes))
+            return failed(UNABLE_TO_OPEN_FILE, inPath, failedOn);
+        stage.bytesIn(inputBytes);
+    }
+    const bool wantTokens = options.writeTokens || options.kind == PipelineKind::STRINGS;
+    const bool modelHit = known && entry.inputHash == inputHash && entry.inputBytes == inputBytes &&
+                          entry.canonical == options.canonical && entry.maxCodeLength == options.maxCodeLength &&
+                          fileMatches(freqPath, entry.freqHash) && fileMatches(hdrPath, entry.hdrHash) &&
+                          (!wantTokens || (entry.hasTokens && fileMatches(tokensPath, entry.tokensHash)));
+
+    report << std::fixed << std::setprecision(3);
+    if (modelHit && entry.codeFormat == options.codeFormat && fileMatches(codePath, entry.codeHash)) {
+        report << "Cache: hit, " << base << ".code is current (" << msSince(start) << " ms)\n"
+               << std::defaultfloat;
+        return NO_ERROR;
+    }
+    bool encoded = false;
+    if (modelHit) {
+        if (error_type st = encodeWithHeader(inPath, hdrPath, codePath, options, encoded, failedOn); st != NO_ERROR)
+            return st;
+    }
+    if (encoded) {
+        entry.codeFormat = options.codeFormat;
+        hashFile(codePath, entry.codeHash);
+        if (error_type st = writeCacheEntry(metaPath, entry); st != NO_ERROR)
+            return failed(st, metaPath, failedOn);
+        report << "Cache: model hit, encoded with the cached " << base << ".hdr (" << msSince(start)
+               << " ms)\n" << std::defaultfloat;
+        return NO_ERROR;
+    }
+
+    report << std::defaultfloat;
+    if (error_type st = runPipeline(inPath, dir, base, options, report, failedOn); st != NO_ERROR)
+        return st;
+    entry = CacheEntry{.inputHash = inputHash, .inputBytes = inputBytes, .canonical = options.canonical,
+                       .maxCodeLength = options.maxCodeLength, .hasTokens = wantTokens,
+                       .codeFormat = options.codeFormat};
+    if (!hashFile(freqPath, entry.freqHash) || !hashFile(hdrPath, entry.hdrHash) ||
+        !hashFile(codePath, entry.codeHash) || (wantTokens && !hashFile(tokensPath, entry.tokensHash)))
+        return failed(UNABLE_TO_OPEN_FILE, dir, failedOn);
+    if (error_type st = writeCacheEntry(metaPath, entry); st != NO_ERROR)
+        return failed(st, metaPath, failedOn);
+    report << "Cache: " << (known ? "stale" : "miss") << ", full run (" << std::fixed << std::setprecision(3)
+           << msSince(start) << " ms), wrote " << base << ".meta\n" << std::defaultfloat;
+    return NO_ERROR;
+}
+
+// The format an existing .code was written in: a blocked file ends in a
+// valid block index, a binary one in its bit count; anything else is ASCII
+CodeFormat codeFormatOf(const fs::path& codePath) {
+    std::ifstream in(codePath, std::ios::binary);
+    const std::string raw((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    std::vector<CodeBlock> blocks;
+    std::uint64_t tokenCount = 0;
+    if (readBlockIndex(reinterpret_cast<const unsigned char*>(raw.data()), raw.size(), blocks, tokenCount) == NO_ERROR) {
+        return CodeFormat::BLOCKED;
+    }
+    std::istringstream binary(raw);
+    std::vector<unsigned char> bytes;
+    std::uint64_t bitCount = 0;
+    return readCodeFile(binary, CodeFormat::BINARY, bytes, bitCount) == NO_ERROR ? CodeFormat::BINARY
+                                                                                 : CodeFormat::ASCII;
+}
+
+// compressFile() minus the exit: the first error, with the file it concerns in 'failedOn'
+error_type compressFileStatus(const fs::path& inPath, const fs::path& dir, const PipelineOptions& options,
+                              std::ostream& report, std::string& failedOn) {
+    const std::string base = inPath.stem().string();
+
+    // SAFTEY CHECKS
+    if (error_type st; (st = regularFileExistsAndIsAvailable(inPath.string())) != NO_ERROR)
+        return failed(st, inPath, failedOn);
+    if (error_type st; (st = directoryExists(dir.string())) != NO_ERROR)
+        return failed(st, dir, failedOn);
+    if (options.cache) {
+        return compressCached(inPath, dir, base, options, report, failedOn);
+    }
+    return runPipeline(inPath, dir, base, options, report, failedOn);
+}
+
+} // End of namespace
+
+int compressFile(const fs::path& inPath, const fs::path& dir,
+                 const PipelineOptions& options, std::ostream& report) {
+    std::string failedOn;
+    exitOnError(compressFileStatus(inPath, dir, options, report, failedOn), failedOn);
+    return 0;
+}
+
+int compressBatch(const std::vector<fs::path>& inputs, const PipelineOptions& options, std::ostream& report) {
+    using Clock = std::chrono::steady_clock;
+
+    ThreadPool pool(static_cast<unsigned>(options.threads));
+    PipelineOptions fileOptions = options;
+    fileOptions.pool = &pool;
+    fileOptions.stats = nullptr; // per-stage stats are per process, not per file
+
+    // Largest first, so a big file is not the last thing left running
+    std::vector<std::uintmax_t> sizes(inputs.size(), 0);
+    std::uintmax_t totalBytes = 0;
+    for (std::size_t i = 0; i < inputs.size(); ++i) {
+        std::error_code ec;
+        sizes[i] = fs::file_size(inputs[i], ec);
+        totalBytes += ec ? 0 : sizes[i];
+    }
+    std::vector<std::size_t> order(inputs.size());
+    for (std::size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::ranges::stable_sort(order, [&sizes](std::size_t a, std::size_t b) { return sizes[a] > sizes[b]; });
+
+    // A failed file ends only its own run: its error goes in its report
+    std::vector<std::ostringstream> reports(inputs.size());
+    std::vector<int> status(inputs.size(), 0);
+    const auto start = Clock::now();
+    pool.parallelFor(order.size(), [&](std::size_t k) {
+        const std::size_t i = order[k];
+        const fs::path dir = inputs[i].has_parent_path() ? inputs[i].parent_path() : fs::path(".");
+        std::string failedOn;
+        if (error_type st = compressFileStatus(inputs[i], dir, fileOptions, reports[i], failedOn); st != NO_ERROR) {
+            reports[i] << "Error: " << errorMessage(st, failedOn) << "\n";
+            status[i] = st;
+        }
+    });
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    int exitCode = 0;
+    for (std::size_t i = 0; i < inputs.size(); ++i) {
+        report << "== " << inputs[i].string() << "\n" << reports[i].str();
+        exitCode = std::max(exitCode, status[i]);
+    }
+    const double mb = static_cast<double>(totalBytes) / (1024.0 * 1024.0);
+    report << "Batch: " << inputs.size() << " files, " << std::fixed << std::setprecision(2) << mb << " MB in "
+           << seconds * 1000.0 << " ms on " << pool.size() << " threads ("
+           << (seconds > 0 ? mb / seconds : 0.0) << " MB/s)\n" << std::defaultfloat;
+    return exitCode;
+}
+
+int compressShared(const std::vector<fs::path>& inputs, const fs::path& modelPath,
+                   const PipelineOptions& options, std::ostream& report) {
+    using Clock = std::chrono::steady_clock;
+    auto msSince = [](Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    };
+
+    // Tokenize every file and sum the counts in one BST
+    std::vector<std::vector<std::string>> tokens(inputs.size());
+    BinSearchTree counts(TreeBalance::AVL);
+    for (std::size_t i = 0; i < inputs.size(); ++i) {
+        if (error_type st; (st = regularFileExistsAndIsAvailable(inputs[i].string())) != NO_ERROR)
+            exitOnError(st, inputs[i].string());
+        Scanner scanner(inputs[i]);
+        if (error_type st; (st = scanner.tokenize(tokens[i])) != NO_ERROR)
+            exitOnError(st, inputs[i].string());
+        counts.bulkInsert(tokens[i]);
+    }
+    std::vector<std::pair<std::string, int>> wordCounts;
+    counts.inorderCollect(wordCounts);
+
+    // Reserve an escape for words no file has: Good-Turing puts the chance of
+    // an unseen word near the share of words seen once, so it gets their count.
+    // ESCAPE_WORD sorts before every scanner token, so the order stays lexicographic.
+    if (options.escape) {
+        const auto hapax = std::ranges::count_if(wordCounts, [](const auto& wc) { return wc.second == 1; });
+        wordCounts.insert(wordCounts.begin(), {std::string(ESCAPE_WORD), static_cast<int>(std::max<std::ptrdiff_t>(1, hapax))});
+        report << "Escape word: " << ESCAPE_WORD << " (count " << wordCounts.front().second
+               << ", the number of words seen once)\n";
+    }
+
+    // One model, one header
+    const HuffmanBuildOptions buildOptions{.maxCodeLength = options.maxCodeLength};
+    HuffmanTree model = HuffmanTree::buildFromCounts(wordCounts, buildOptions);
+    if (options.canonical) {
+        model.makeCanonical();
+    }
+    if (error_type st; (st = canOpenForWriting(modelPath.string())) != NO_ERROR)
+        exitOnError(st, modelPath.string());
+    std::uint64_t modelBytes = 0;
+    {
+        std::ostringstream hdr;
+        if (model.writeHeader(hdr) != NO_ERROR)
+            exitOnError(FAILED_TO_WRITE_FILE, modelPath.string());
+        std::ofstream hdrOut(modelPath);
+        hdrOut << hdr.str();
+        if (!hdrOut)
+            exitOnError(FAILED_TO_WRITE_FILE, modelPath.string());
+        modelBytes = hdr.str().size();
+    }
+    // The model's code table and word -> symbol map, built once for every file
+    std::vector<BitCode> codes;
+    std::vector<std::string> stringCodes;
+    if (!model.codeTable(codes)) {
+        model.codeTable(stringCodes);
+    }
+    std::unordered_map<std::string_view, std::uint32_t> symbolOf;
+    symbolOf.reserve(wordCounts.size());
+    for (std::size_t s = 0; s < wordCounts.size(); ++s) {
+        symbolOf.emplace(wordCounts[s].first, static_cast<std::uint32_t>(s));
+    }
+    auto encodeWithModel = [&](const std::vector<std::string>& words, std::ostream& os) {
+        std::vector<std::uint32_t> symbols(words.size());
+        for (std::size_t t = 0; t < words.size(); ++t) {
+            symbols[t] = symbolOf.find(words[t])->second; // every word was counted
+        }
+        return stringCodes.empty() ? HuffmanTree::encodeWithTable(codes, symbols, os, options.codeFormat)
+                                   : HuffmanTree::encodeWithTable(stringCodes, symbols, os, options.codeFormat);
+    };
+
+    report << "Shared model: " << modelPath.string() << " (" << wordCounts.size() << " words from "
+           << inputs.size() << " files, " << modelBytes << " bytes)\n";
+    report << std::left << std::setw(40) << "file" << std::right << std::setw(10) << "tokens"
+           << std::setw(14) << "shared .code" << std::setw(11) << "encode ms"
+           << std::setw(14) << "own hdr+code" << std::setw(17) << "build+encode ms" << "\n";
+
+    // A file whose .code cannot be written gets the error as its row; the
+    // others still run and the worst error is the exit code
+    int exitCode = 0;
+    auto failedRow = [&](std::size_t i, error_type st, const std::string& failedOn) {
+        report << std::left << std::setw(40) << inputs[i].filename().string() << std::right
+               << "  Error: " << errorMessage(st, failedOn) << "\n";
+        exitCode = std::max(exitCode, static_cast<int>(st));
+    };
+
+    std::uint64_t sharedTotal = modelBytes;
+    std::uint64_t ownTotal = 0;
+    double sharedMs = 0;
+    double ownMs = 0;
+    for (std::size_t i = 0; i < inputs.size(); ++i) {
+        // Encode with the shared model, then write <base>.code
+        std::ostringstream code;
+        auto start = Clock::now();
+        if (error_type st = encodeWithModel(tokens[i], code); st != NO_ERROR) {
+            failedRow(i, st, inputs[i].string());
+            continue;
+        }
+        const double encodeMs = msSince(start);
+        const fs::path codePath = fs::path(inputs[i]).replace_extension(".code");
+        std::string failedOn;
+        if (error_type st = writeCode(codePath, [&](std::ostream& os) {
+                os << code.str();
+                return NO_ERROR;
+            }, failedOn); st != NO_ERROR) {
+            failedRow(i, st, failedOn);
+            continue;
+        }
+
+        // What this file's own model would have cost (kept in memory)
+        start = Clock::now();
+        BinSearchTree own(TreeBalance::AVL);
+        own.bulkInsert(tokens[i]);
+        std::vector<std::pair<std::string, int>> ownCounts;
+        own.inorderCollect(ownCounts);
+        HuffmanTree ownTree = HuffmanTree::buildFromCounts(ownCounts, buildOptions);
+        if (options.canonical) {
+            ownTree.makeCanonical();
+        }
+        std::ostringstream ownHdr;
+        std::ostringstream ownCode;
+        if (ownTree.writeHeader(ownHdr) != NO_ERROR ||
+            ownTree.encode(tokens[i], ownCode, options.codeFormat) != NO_ERROR) {
+            failedRow(i, FAILED_TO_WRITE_FILE, inputs[i].string());
+            continue;
+        }
+        const double ownFileMs = msSince(start);
+        const std::uint64_t ownBytes = ownHdr.str().size() + ownCode.str().size();
+
+        sharedTotal += code.str().size();
+        ownTotal += ownBytes;
+        sharedMs += encodeMs;
+        ownMs += ownFileMs;
+        report << std::left << std::setw(40) << inputs[i].filename().string() << std::right
+               << std::setw(10) << tokens[i].size() << std::setw(14) << code.str().size()
+               << std::fixed << std::setprecision(3) << std::setw(11) << encodeMs
+               << std::setw(14) << ownBytes << std::setw(17) << ownFileMs << "\n" << std::defaultfloat;
+    }
+    report << "Total: shared " << sharedTotal << " bytes (model " << modelBytes << " + codes "
+           << sharedTotal - modelBytes << ") vs per-file models " << ownTotal << " bytes ("
+           << std::fixed << std::setprecision(2) << std::showpos
+           << (ownTotal ? 100.0 * (static_cast<double>(sharedTotal) / static_cast<double>(ownTotal) - 1.0) : 0.0)
+           << "%)\n" << std::noshowpos;
+    report << "Encode time: shared " << std::setprecision(3) << sharedMs << " ms vs per-file build+encode "
+           << ownMs << " ms\n" << std::defaultfloat;
+    return exitCode;
+}
+
+int updateModel(const fs::path& inPath, const fs::path& dir, const fs::path& deltaPath,
+                const PipelineOptions& options, std::ostream& report) {
+    const std::string base = inPath.stem().string();
+    const fs::path freqPath = dir / (base + ".freq");
+    const fs::path hdrPath = dir / (base + ".hdr");
+    const fs::path codePath = dir / (base + ".code");
+
+    WordCounts baseCounts;
+    WordCounts deltaCounts;
+    std::vector<std::pair<std::string, std::string>> codebook;
+    bool canonical = options.canonical;
+    if (error_type st; (st = readFreqFile(freqPath, baseCounts)) != NO_ERROR)
+        exitOnError(st, freqPath.string());
+    if (error_type st; (st = readFreqFile(deltaPath, deltaCounts)) != NO_ERROR)
+        exitOnError(st, deltaPath.string());
+    {
+        std::ifstream hdrIn(hdrPath);
+        canonical |= hdrIn.peek() == '#'; // a rebuilt header keeps the canonical form
+        if (error_type st; (st = HuffmanTree::readHeader(hdrIn, codebook)) != NO_ERROR)
+            exitOnError(st, hdrPath.string());
+    }
+    auto tokensIn = [](const WordCounts& counts) {
+        std::uint64_t total = 0;
+        for (const auto& [word, count] : counts) total += static_cast<std::uint64_t>(count);
+        return total;
+    };
+
+    // Merged table, and what it costs with the old codes, fresh codes and at best
+    WordCounts merged;
+    if (error_type st; (st = mergeCounts(baseCounts, deltaCounts, merged)) != NO_ERROR)
+        exitOnError(st, deltaPath.string());
+    const double entropy = entropyBits(merged);
+    const CodingCost oldCost = codingCost(merged, codebook);
+    HuffmanTree rebuilt = HuffmanTree::buildFromCounts(merged, {.maxCodeLength = options.maxCodeLength});
+    if (canonical) {
+        rebuilt.makeCanonical();
+    }
+    const std::uint64_t newBits = rebuilt.encodedBits();
+    auto overEntropy = [entropy](double bits) { return entropy > 0 ? bits / entropy - 1.0 : 0.0; };
+
+    report << "Merged: " << freqPath.string() << " (" << baseCounts.size() << " words, " << tokensIn(baseCounts)
+           << " tokens) + " << deltaPath.string() << " (" << deltaCounts.size() << " words, "
+           << tokensIn(deltaCounts) << " tokens) -> " << merged.size() << " words, " << tokensIn(merged)
+           << " tokens\n";
+    report << std::fixed << std::setprecision(0) << "Entropy: " << entropy << " bits\n";
+    if (oldCost.uncodedWords > 0) {
+        report << "Old codes: cannot code " << oldCost.uncodedWords << " new words (no escape word)\n";
+    } else {
+        report << "Old codes: " << oldCost.bits << " bits (" << std::setprecision(2) << std::showpos
+               << 100.0 * overEntropy(static_cast<double>(oldCost.bits)) << "% over entropy" << std::noshowpos;
+        if (oldCost.escapedWords > 0) {
+            report << ", " << oldCost.escapedWords << " words escaped";
+        }
+        report << ")\n";
+    }
+    report << "Rebuilt codes: " << newBits << " bits (" << std::setprecision(2) << std::showpos
+           << 100.0 * overEntropy(static_cast<double>(newBits)) << "% over entropy)\n" << std::noshowpos;
+
+    // Rebuild only when the old codes drifted past the threshold
+    const bool rebuild = oldCost.uncodedWords > 0 ||
+                         overEntropy(static_cast<double>(oldCost.bits)) > options.rebuildThreshold;
+    const auto drift = static_cast<std::int64_t>(oldCost.bits) - static_cast<std::int64_t>(newBits);
+    report << "Decision: " << (rebuild ? "rebuild " : "keep ") << hdrPath.string() << " (threshold "
+           << 100.0 * options.rebuildThreshold << "% over entropy): ";
+    if (oldCost.uncodedWords > 0) {
+        report << "required\n";
+    } else if (rebuild) {
+        report << "saves " << drift << " bits\n";
+    } else {
+        report << "loses " << drift << " bits against a rebuild\n";
+    }
+    report << std::defaultfloat;
+
+    // New codes make <base>.code undecodable: re-encode the input in the
+    // format it was written in, in memory first so nothing is half-replaced
+    std::string code;
+    CodeFormat codeFormat = CodeFormat::ASCII;
+    const bool reencode = rebuild && fs::exists(codePath);
+    if (reencode) {
+        if (error_type st; (st = regularFileExistsAndIsAvailable(inPath.string())) != NO_ERROR)
+            exitOnError(st, inPath.string());
+        std::vector<std::string> tokens;
+        Scanner scanner(inPath);
+        if (error_type st; (st = scanner.tokenize(tokens)) != NO_ERROR)
+            exitOnError(st, inPath.string());
+        codeFormat = codeFormatOf(codePath);
+        std::ostringstream codeOut;
+        if (error_type st; (st = rebuilt.encode(tokens, codeOut, codeFormat)) != NO_ERROR)
+            exitOnError(st, inPath.string());
+        code = std::move(codeOut).str();
+    }
+
+    // The merged table always replaces <base>.freq; the header only on a rebuild
+    std::vector<std::string_view> words;
+    std::vector<int> freqs;
+    words.reserve(merged.size());
+    freqs.reserve(merged.size());
+    for (const auto& [word, count] : merged) {
+        words.push_back(word);
+        freqs.push_back(count);
+    }
+    std::string failedOn;
+    exitOnError(writeFreq(freqPath, words, freqs, failedOn), failedOn);
+    if (rebuild) {
+        if (error_type st; (st = canOpenForWriting(hdrPath.string())) != NO_ERROR)
+            exitOnError(st, hdrPath.string());
+        std::ofstream hdrOut(hdrPath);
+        if (rebuilt.writeHeader(hdrOut) != NO_ERROR || !hdrOut)
+            exitOnError(FAILED_TO_WRITE_FILE, hdrPath.string());
+    }
+    if (reencode) {
+        exitOnError(writeCode(codePath, [&](std::ostream& os) {
+            os << code;
+            return NO_ERROR;
+        }, failedOn), failedOn);
+        report << "Re-encoded: " << codePath.string() << " ("
+               << (codeFormat == CodeFormat::BLOCKED ? "blocked" : codeFormat == CodeFormat::BINARY ? "binary" : "ascii")
+               << ", " << code.size() << " bytes)\n";
+    }
+
+    // The .freq (and maybe .hdr) no longer come from the input alone: a
+    // --cache entry for them would be stale, so it goes
+    const fs::path metaPath = dir / (base + ".meta");
+    if (std::error_code ec; fs::remove(metaPath, ec)) {
+        report << "Removed: " << metaPath.string() << "\n";
+    }
+    return 0;
+}
+
+int compressWithModel(const fs::path& inPath, const fs::path& dir, const fs::path& modelPath,
+                      const PipelineOptions& options, std::ostream& report) {
+    const std::string base = inPath.stem().string();
+    const fs::path tokensPath = dir / (base + ".tokens");
+    const fs::path codePath = dir / (base + ".code");
+
+    if (error_type st; (st = regularFileExistsAndIsAvailable(inPath.string())) != NO_ERROR)
+        exitOnError(st, inPath.string());
+    if (error_type st; (st = regularFileExistsAndIsAvailable(modelPath.string())) != NO_ERROR)
+        exitOnError(st, modelPath.string());
+
+    std::vector<std::string> tokens;
+    Scanner scanner(inPath);
+    if (error_type st; (st = scanner.tokenize(tokens)) != NO_ERROR)
+        exitOnError(st, inPath.string());
+    if (options.writeTokens) {
+        LineWriter out(tokensPath);
+        if (!out.isOpen())
+            exitOnError(UNABLE_TO_OPEN_FILE_FOR_WRITING, tokensPath.string());
+        for (const std::string& token : tokens) {
+            out.add(token);
+        }
+        if (out.finish() != NO_ERROR)
+            exitOnError(FAILED_TO_WRITE_FILE, tokensPath.string());
+    }
+
+    // The model's codes, numbered in header order
+    std::vector<std::pair<std::string, std::string>> codebook;
+    std::ifstream hdrIn(modelPath);
+    if (error_type st; (st = HuffmanTree::readHeader(hdrIn, codebook)) != NO_ERROR)
+        exitOnError(st, modelPath.string());
+    std::unordered_map<std::string_view, std::uint32_t> symbolOf;
+    std::vector<std::string> codes;
+    symbolOf.reserve(codebook.size());
+    codes.reserve(codebook.size());
+    for (const auto& [word, code] : codebook) {
+        symbolOf.emplace(word, static_cast<std::uint32_t>(codes.size()));
+        codes.push_back(code);
+    }
+    const auto escape = symbolOf.find(ESCAPE_WORD);
+
+    // Words the model lacks go out as the escape plus their spelling
+    std::vector<std::uint32_t> symbols;
+    std::vector<std::string> literals;
+    std::unordered_map<std::string_view, int> unseen;
+    symbols.reserve(tokens.size());
+    for (const std::string& token : tokens) {
+        if (const auto it = symbolOf.find(token); it != symbolOf.end()) {
+            symbols.push_back(it->second);
+            continue;
+        }
+        if (escape == symbolOf.end())
+            exitOnError(WORD_NOT_IN_CODEBOOK, token);
+        symbols.push_back(escape->second);
+        literals.push_back(token);
+        ++unseen[token];
+    }
+
+    std::uint64_t literalBits = 0;
+    for (const std::string& literal : literals) {
+        literalBits += 2 * std::bit_width(literal.size() + 1) - 1 + 8 * literal.size();
+    }
+    report << "Model: " << modelPath.string() << " (" << codebook.size() << " words)\n";
+    report << "Tokens: " << tokens.size() << "\n";
+    report << "Escaped tokens: " << literals.size() << " (" << unseen.size() << " distinct words, "
+           << literalBits << " literal bits)\n";
+
+    std::string failedOn;
+    exitOnError(writeCode(codePath, [&](std::ostream& os) {
+        return HuffmanTree::encodeWithEscapes(codes, escape == symbolOf.end() ? UINT32_MAX : escape->second,
+                                              symbols, literals, os, options.codeFormat);
+    }, failedOn), failedOn);
+    return 0;
+}
+
+int compressAdaptive(const fs::path& inPath, const fs::path& outPath, std::ostream& report) {
+    using Clock = std::chrono::steady_clock;
+    const bool fromStdin = inPath == "-";
+    const bool toStdout = outPath == "-";
+
+    if (!fromStdin) {
+        if (error_type st; (st = regularFileExistsAndIsAvailable(inPath.string())) != NO_ERROR)
+            exitOnError(st, inPath.string());
+    }
+    std::ofstream fileOut;
+    if (!toStdout) {
+        if (error_type st; (st = canOpenForWriting(outPath.string())) != NO_ERROR)
+            exitOnError(st, outPath.string());
+        fileOut.open(outPath, std::ios::binary);
+    }
+    std::ostream& out = toStdout ? std::cout : fileOut;
+
+    // Every token goes straight through the model into the bit writer
+    class AdaptiveSink : public TokenSink {
+    public:
+        explicit AdaptiveSink(std::ostream& os) : writer(os) {}
+        void token(std::string_view word) override { model.encode(word, writer); }
+        AdaptiveHuffman model;
+        BitWriter writer;
+    } sink(out);
+
+    const auto start = Clock::now();
+    if (fromStdin) {
+        std::string line;
+        while (std::getline(std::cin, line)) {
+            Scanner::scanBuffer(line, sink);
+            if (sink.writer.drain() != NO_ERROR)
+                exitOnError(FAILED_TO_WRITE_FILE, outPath.string());
+        }
+    } else {
+        Scanner scanner(inPath);
+        if (error_type st; (st = scanner.scan(sink)) != NO_ERROR)
+            exitOnError(st, inPath.string());
+    }
+    sink.model.finish(sink.writer);
+    if (sink.writer.flush() != NO_ERROR || !out.flush())
+        exitOnError(FAILED_TO_WRITE_FILE, outPath.string());
+    const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    const std::uint64_t bytes = sink.writer.bitCount() / 8;
+    const std::uint64_t tokens = sink.model.tokenCount();
+    report << "Tokens: " << tokens << "\n";
+    report << "Distinct words: " << sink.model.wordCount() << "\n";
+    report << "Adaptive code: " << bytes << " bytes (" << std::fixed << std::setprecision(3)
+           << (tokens ? 8.0 * static_cast<double>(bytes) / static_cast<double>(tokens) : 0.0)
+           << " bits/token)\n";
+    report << "Encode time: " << ms << " ms\n" << std::defaultfloat;
+    return 0;
+}
+
+int decodeAdaptive(const fs::path& inPath, const fs::path& outPath, std::ostream& report) {
+    using Clock = std::chrono::steady_clock;
+    const bool fromStdin = inPath == "-";
+    const bool toStdout = outPath == "-";
+
+    std::ifstream fileIn;
+    if (!fromStdin) {
+        if (error_type st; (st = regularFileExistsAndIsAvailable(inPath.string())) != NO_ERROR)
+            exitOnError(st, inPath.string());
+        fileIn.open(inPath, std::ios::binary);
+    }
+    std::ofstream fileOut;
+    if (!toStdout) {
+        if (error_type st; (st = canOpenForWriting(outPath.string())) != NO_ERROR)
+            exitOnError(st, outPath.string());
+        fileOut.open(outPath, std::ios::binary);
+    }
+    std::ostream& out = toStdout ? std::cout : fileOut;
+
+    // Up to 'max' bytes of input as soon as there are any; 0 at its end.
+    // On a pipe this returns what has arrived instead of waiting for 'max'
+    auto readSome = [&](unsigned char* to, std::size_t max) -> std::size_t {
+        if (!fromStdin) {
+            fileIn.read(reinterpret_cast<char*>(to), static_cast<std::streamsize>(max));
+            return static_cast<std::size_t>(fileIn.gcount());
+        }
+#if HAVE_POSIX_READ
+        for (;;) {
+            const ssize_t n = ::read(STDIN_FILENO, to, max);
+            if (n >= 0 || errno != EINTR) {
+                return n > 0 ? static_cast<std::size_t>(n) : 0;
+            }
+        }
+#else
+        const int first = std::cin.get(); // waits for one byte only
+        if (first == std::char_traits<char>::eof()) {
+            return 0;
+        }
+        to[0] = static_cast<unsigned char>(first);
+        return 1 + static_cast<std::size_t>(std::cin.readsome(reinterpret_cast<char*>(to + 1),
+                                                              static_cast<std::streamsize>(max - 1)));
+#endif
+    };
+
+    // Decode whatever has arrived. A code cut off by the end of the buffer
+    // leaves the model as it was and is decoded again, from the same bit, once
+    // more input is in. Output is flushed before every read that may wait.
+    constexpr std::size_t CHUNK_BYTES = 1 << 16;
+    const auto start = Clock::now();
+    AdaptiveHuffman model;
+    std::vector<unsigned char> buffer;
+    int bitOffset = 0; // bits of buffer[0] already decoded
+    bool atEnd = false;
+    std::string text;
+    for (bool done = false; !done;) {
+        const std::uint64_t bits = 8 * static_cast<std::uint64_t>(buffer.size());
+        BitReader reader(buffer.data(), buffer.size(), bits);
+        reader.skip(bitOffset);
+        std::uint64_t consumed = static_cast<std::uint64_t>(bitOffset);
+        std::string_view word;
+        while (model.decode(reader, word) == NO_ERROR) {
+            consumed = bits - reader.remaining();
+            if (word.empty()) {
+                done = true;
+                break;
+            }
+            text += word;
+            text += '\n';
+        }
+        out << text;
+        text.clear();
+        if (!out.flush())
+            exitOnError(FAILED_TO_WRITE_FILE, outPath.string());
+        if (done) {
+            break;
+        }
+        if (atEnd)
+            exitOnError(CORRUPT_CODE_FILE, inPath.string()); // no end marker, or bits that decode to nothing
+
+        buffer.erase(buffer.begin(), buffer.begin() + static_cast<std::ptrdiff_t>(consumed / 8));
+        bitOffset = static_cast<int>(consumed % 8);
+        const std::size_t kept = buffer.size();
+        buffer.resize(kept + CHUNK_BYTES);
+        const std::size_t got = readSome(buffer.data() + kept, CHUNK_BYTES);
+        buffer.resize(kept + got);
+        atEnd = got == 0;
+    }
+    const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    report << "Decoded tokens: " << model.tokenCount() << "\n";
+    report << "Decode time: " << ms << " ms\n";
+    return 0;
+}
+
+// Decode mode: <base>.hdr + <base>.code -> <base>.decoded (one token per line, like .tokens)
+int decodeFile(const fs::path& dir, const std::string& base, const DecodeOptions& options, std::ostream& report) {
+    using Clock = std::chrono::steady_clock;
+
+    const fs::path hdrPath = options.modelPath.empty() ? dir / (base + ".hdr") : options.modelPath;
+    const fs::path codePath = dir / (base + ".code");
+    const fs::path decodedPath = dir / (base + ".decoded");
+
+    if (error_type st; (st = regularFileExistsAndIsAvailable(hdrPath.string())) != NO_ERROR)
+        exitOnError(st, hdrPath.string());
+    if (error_type st; (st = regularFileExistsAndIsAvailable(codePath.string())) != NO_ERROR)
+        exitOnError(st, codePath.string());
+    if (error_type st; (st = canOpenForWriting(decodedPath.string())) != NO_ERROR)
+        exitOnError(st, decodedPath.string());
+
+    // Rebuild the code table from the header
+    std::vector<std::pair<std::string, std::string>> codebook;
+    std::ifstream hdrIn(hdrPath);
+    if (error_type st; (st = HuffmanTree::readHeader(hdrIn, codebook)) != NO_ERROR)
+        exitOnError(st, hdrPath.string());
+
+    // An empty header (empty input) has no tables; its .code must hold no tokens
+    const auto tablesStart = Clock::now();
+    HuffmanDecoder decoder;
+    if (error_type st; !codebook.empty() && (st = decoder.buildTables(codebook)) != NO_ERROR)
+        exitOnError(st, hdrPath.string());
+    const auto tablesEnd = Clock::now();
+
+    std::vector<unsigned char> bytes;
+    std::uint64_t bitCount = 0;
+    std::vector<std::uint32_t> symbols;
+    std::vector<std::string> literals;
+    std::ifstream codeIn(codePath, std::ios::binary);
+    Clock::time_point decodeStart;
+    Clock::time_point decodeEnd;
+    if (options.codeFormat == CodeFormat::BLOCKED) {
+        // Load the file and its block index
+        bytes.assign(std::istreambuf_iterator<char>(codeIn), std::istreambuf_iterator<char>());
+        std::vector<CodeBlock> blocks;
+        std::uint64_t tokenCount = 0;
+        if (error_type st; (st = readBlockIndex(bytes.data(), bytes.size(), blocks, tokenCount)) != NO_ERROR)
+            exitOnError(st, codePath.string());
+        if (codebook.empty() && tokenCount != 0)
+            exitOnError(CORRUPT_CODE_FILE, codePath.string());
+
+        // Random access: decode just the block that holds the token
+        if (options.seekToken >= 0) {
+            const auto token = static_cast<std::uint64_t>(options.seekToken);
+            std::uint32_t symbol = 0;
+            std::string literal;
+            if (token >= tokenCount) {
+                std::cerr << "Token " << token << " is past the end (" << tokenCount << " tokens)\n";
+                return 1;
+            }
+            const auto seekStart = Clock::now();
+            if (error_type st; (st = decodeToken(decoder, bytes.data(), blocks, token, symbol, &literal)) != NO_ERROR)
+                exitOnError(st, codePath.string());
+            const double seekMs = std::chrono::duration<double, std::milli>(Clock::now() - seekStart).count();
+            report << "Token " << token << ": " << (decoder.isEscape(symbol) ? literal : decoder.word(symbol)) << "\n";
+            report << "Decoded 1 of " << blocks.size() << " blocks in " << seekMs << " ms\n";
+            return 0;
+        }
+
+        const std::size_t indexBytes = blocks.size() * BlockWriter::INDEX_ENTRY_BYTES + BlockWriter::TRAILER_BYTES;
+        bitCount = 8 * static_cast<std::uint64_t>(bytes.size() - indexBytes);
+        report << "Blocks: " << blocks.size() << " of up to " << (blocks.empty() ? 0 : blocks.front().tokenCount)
+               << " tokens\n";
+        report << "Index overhead: " << indexBytes << " bytes (" << std::fixed << std::setprecision(3)
+               << 100.0 * static_cast<double>(indexBytes) / static_cast<double>(bytes.size()) << "% of .code)\n"
+               << std::defaultfloat;
+
+        // Decode (timed on its own), blocks in parallel when asked
+        decodeStart = Clock::now();
+        error_type st;
+        if (options.threads == 1) {
+            st = decodeBlocks(decoder, bytes.data(), blocks, tokenCount, symbols, &literals);
+        } else {
+            ThreadPool pool(static_cast<unsigned>(options.threads));
+            st = decodeBlocks(decoder, bytes.data(), blocks, tokenCount, symbols, pool, &literals);
+        }
+        decodeEnd = Clock::now();
+        if (st != NO_ERROR)
+            exitOnError(st, codePath.string());
+    } else {
+        // Load the bits
+        if (error_type st; (st = readCodeFile(codeIn, options.codeFormat, bytes, bitCount)) != NO_ERROR)
+            exitOnError(st, codePath.string());
+        if (codebook.empty() && bitCount != 0)
+            exitOnError(CORRUPT_CODE_FILE, codePath.string());
+
+        // Decode (timed on its own: this is the part we care about in production)
+        decodeStart = Clock::now();
+        if (error_type st;
+            !codebook.empty() && (st = decoder.decodeSymbols(bytes, bitCount, symbols, &literals)) != NO_ERROR)
+            exitOnError(st, codePath.string());
+        decodeEnd = Clock::now();
+    }
+
+    std::string text;
+    std::size_t nextLiteral = 0;
+    for (std::uint32_t s : symbols) {
+        text += decoder.isEscape(s) ? literals[nextLiteral++] : decoder.word(s);
+        text += '\n';
+    }
+    std::ofstream decodedOut(decodedPath, std::ios::binary);
+    decodedOut << text;
+    if (!decodedOut)
+        exitOnError(FAILED_TO_WRITE_FILE, decodedPath.string());
+
+    const double tableMs = std::chrono::duration<double, std::milli>(tablesEnd - tablesStart).count();
+    const double seconds = std::chrono::duration<double>(decodeEnd - decodeStart).count();
+    const double mb = 1024.0 * 1024.0;
+    report << "Decoded tokens: " << symbols.size() << "\n";
+    report << "Max code length: " << decoder.maxCodeLength() << " bits\n";
+    report << "Table build time: " << tableMs << " ms\n";
+    report << "Decode time: " << seconds * 1000.0 << " ms\n";
+    if (seconds > 0) {
+        report << "Decode throughput: " << (bitCount / 8.0) / mb / seconds << " MB/s compressed, "
+               << text.size() / mb / seconds << " MB/s decoded text\n";
+    }
+    return 0;
+}
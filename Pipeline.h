@@ -0,0 +1,125 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "BitStream.h"
+#include "FlatHuffmanTree.h"
+#include "FrequencyCounter.h"
+#include "PipelineStats.h"
+
+class ThreadPool;
+
+// How tokens travel between the stages.
+//   INTERNED - the scanner gives every distinct word a dense uint32_t ID;
+//              counting, tree building and encoding work on ID arrays and
+//              ID-indexed tables. Strings are only written out (.tokens/.freq/.hdr).
+//   STREAMING - two passes over the memory-mapped input and no token array:
+//              pass 1 scans and counts, pass 2 re-scans and sends each code
+//              straight to the bit writer. Memory follows the vocabulary size.
+//   STRINGS  - the original path: std::vector<std::string> tokens, read back
+//              from .tokens, counted by a FrequencyCounter, encoded by word lookup.
+// All three write byte-identical files.
+enum class PipelineKind { INTERNED, STREAMING, STRINGS };
+
+struct PipelineOptions {
+    PipelineKind kind = PipelineKind::INTERNED;
+    CounterKind counter = CounterKind::BST;   // STRINGS only
+    CodeFormat codeFormat = CodeFormat::ASCII;
+    bool canonical = false;
+    int maxCodeLength = 0;                    // 0 = unbounded
+    int threads = 1;                          // 0 = all cores
+    TreeLayout layout = TreeLayout::POINTER;  // INTERNED and STREAMING
+    bool writeTokens = true;                  // STRINGS always writes (and re-reads) .tokens
+    PipelineStats* stats = nullptr;           // --stats: filled with one entry per stage
+    ThreadPool* pool = nullptr;               // run parallel stages here instead of a pool of 'threads'
+    bool escape = false;                      // compressShared: give the model an ESCAPE_WORD for unseen words
+    bool cache = false;                       // compressFile: reuse outputs recorded in <base>.meta (see ModelCache.h)
+    double rebuildThreshold = 0.05;           // updateModel: rebuild once the old codes cost 5% over the entropy
+};
+
+// Scan 'inPath' and write <base>.tokens (optional), .freq, .hdr and .code into 'dir',
+// printing the token statistics to 'report'. Exits through exitOnError() on
+// file errors; returns the process exit code otherwise.
+// With options.cache the input's hash is checked against <base>.meta first:
+// a current .code means nothing is done, a current model means the input is
+// encoded with <base>.hdr's codes (no counting or tree building), and
+// otherwise the full run records a new <base>.meta. Reports which it was and
+// how long it took.
+int compressFile(const std::filesystem::path& inPath, const std::filesystem::path& dir,
+                 const PipelineOptions& options, std::ostream& report);
+
+// Batch mode: compress every file of 'inputs', each one's outputs next to it,
+// on one work-stealing pool of options.threads threads (0 = all cores).
+// Files run in parallel, largest first; a large file also splits its
+// tokenize and encode into chunks on the same pool, so idle threads steal
+// those once the other files are done. Prints each file's report in input
+// order, then the total throughput. A file error does not stop the batch:
+// it ends that file's report, and the worst one is the returned exit code.
+int compressBatch(const std::vector<std::filesystem::path>& inputs,
+                  const PipelineOptions& options, std::ostream& report);
+
+// Shared-model mode: count every file of 'inputs' into one BinSearchTree,
+// build one Huffman tree from the summed counts and write its header to
+// 'modelPath' once; then write only <base>.code for each file, encoded with
+// that tree. Prints, per file and in total, the output size and encode time
+// next to what a per-file model (own .hdr + .code) would cost. Every input
+// must be readable before the model is built; a .code that cannot be written
+// becomes that file's row, and the worst such error is the exit code.
+int compressShared(const std::vector<std::filesystem::path>& inputs, const std::filesystem::path& modelPath,
+                   const PipelineOptions& options, std::ostream& report);
+
+// Incremental model update: merge the counts of 'deltaPath' (a .freq file,
+// e.g. of text appended to the corpus) into <base>.freq in 'dir'. The merged
+// table's cost under the codes of <base>.hdr is compared with its entropy;
+// past options.rebuildThreshold (a fraction over the entropy), or if a new
+// word has no code, the tree is rebuilt and <base>.hdr rewritten (canonical
+// if it was, or with options.canonical); an existing <base>.code is then
+// re-encoded from 'inPath' with the new codes, in the format it had.
+// Otherwise the header stays and .code files written with it remain
+// decodable. <base>.meta (--cache) is removed, as <base>.freq no longer
+// matches the input. Logs the costs, the decision and the bits it saves or
+// loses against a rebuild.
+int updateModel(const std::filesystem::path& inPath, const std::filesystem::path& dir,
+                const std::filesystem::path& deltaPath, const PipelineOptions& options,
+                std::ostream& report);
+
+// Encode 'inPath' with an existing model header instead of building one:
+// writes <base>.tokens (optional) and <base>.code into 'dir', no .freq or .hdr.
+// Words the model has no code for are sent as its ESCAPE_WORD followed by
+// their spelling; without an escape they are an error. Reports how many
+// tokens were escaped and what their literals cost.
+int compressWithModel(const std::filesystem::path& inPath, const std::filesystem::path& dir,
+                      const std::filesystem::path& modelPath, const PipelineOptions& options,
+                      std::ostream& report);
+
+// Adaptive mode: one pass, no .freq or .hdr. Every token is encoded with
+// AdaptiveHuffman as soon as it is scanned. "-" as 'inPath' reads standard
+// input line by line and flushes the whole bytes written so far after each
+// line, so output lags input by at most one line; "-" as 'outPath' writes
+// standard output.
+int compressAdaptive(const std::filesystem::path& inPath, const std::filesystem::path& outPath,
+                     std::ostream& report);
+
+// Adaptive stream -> one token per line (like .tokens). "-" as above: input
+// is decoded as it arrives and each batch of lines is flushed before the
+// next read, so a pipe from compressAdaptive() is decoded line by line.
+int decodeAdaptive(const std::filesystem::path& inPath, const std::filesystem::path& outPath,
+                   std::ostream& report);
+
+struct DecodeOptions {
+    CodeFormat codeFormat = CodeFormat::ASCII;
+    int threads = 1;             // BLOCKED: decode blocks on N threads (0 = all cores)
+    std::int64_t seekToken = -1; // BLOCKED: only decode and print this token
+    std::filesystem::path modelPath; // shared model header to decode with, instead of <base>.hdr
+};
+
+// <base>.hdr + <base>.code in 'dir' -> <base>.decoded (one token per line, like .tokens)
+int decodeFile(const std::filesystem::path& dir, const std::string& base,
+               const DecodeOptions& options, std::ostream& report);
+
+#endif //PIPELINE_H
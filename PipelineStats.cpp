@@ -0,0 +1,83 @@
+#include "PipelineStats.h"
+#include <cstdio>
+#include <iomanip>
+#include <system_error>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define HAVE_GETRUSAGE 1
+#include <sys/resource.h>
+#endif
+
+long PipelineStats::peakRssKb() noexcept {
+#ifdef HAVE_GETRUSAGE
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return -1;
+    }
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024; // bytes on macOS
+#else
+    return usage.ru_maxrss;        // kilobytes on Linux
+#endif
+#else
+    return -1;
+#endif
+}
+
+void PipelineStats::print(std::ostream& os, bool json) const {
+    if (json) {
+        char buf[384];
+        os << "{\"stages\": [";
+        for (std::size_t i = 0; i < stages_.size(); ++i) {
+            const StageStats& s = stages_[i];
+            std::snprintf(buf, sizeof buf,
+                          "%s\n  {\"stage\": \"%s\", \"wall_ms\": %.3f, \"bytes_in\": %llu, \"bytes_out\": %llu, "
+                          "\"tokens\": %llu, \"distinct\": %llu, \"peak_rss_kb\": %ld, \"allocations\": %llu}",
+                          i == 0 ? "" : ",", s.name.c_str(), s.wallMs,
+                          static_cast<unsigned long long>(s.bytesIn), static_cast<unsigned long long>(s.bytesOut),
+                          static_cast<unsigned long long>(s.tokens), static_cast<unsigned long long>(s.distinct),
+                          s.peakRssKb, static_cast<unsigned long long>(s.allocations));
+            os << buf;
+        }
+        os << "\n]}\n";
+        return;
+    }
+
+    os << std::left << std::setw(14) << "Stage" << std::right << std::setw(11) << "wall ms"
+       << std::setw(12) << "bytes in" << std::setw(12) << "bytes out" << std::setw(11) << "tokens"
+       << std::setw(10) << "distinct" << std::setw(13) << "peak RSS KB" << std::setw(13) << "allocations" << "\n";
+    double totalMs = 0;
+    for (const StageStats& s : stages_) {
+        totalMs += s.wallMs;
+        os << std::left << std::setw(14) << s.name << std::right << std::fixed << std::setprecision(3)
+           << std::setw(11) << s.wallMs << std::setw(12) << s.bytesIn << std::setw(12) << s.bytesOut
+           << std::setw(11) << s.tokens << std::setw(10) << s.distinct << std::setw(13) << s.peakRssKb
+           << std::setw(13) << s.allocations << "\n";
+    }
+    os << std::left << std::setw(14) << "total" << std::right << std::setw(11) << totalMs << "\n"
+       << std::defaultfloat;
+}
+
+void ScopedStage::begin(const char* name) {
+    stage_.name = name;
+    allocationsAtStart_ = PipelineStats::allocations();
+    start_ = Clock::now();
+}
+
+void ScopedStage::end() {
+    stage_.wallMs = std::chrono::duration<double, std::milli>(Clock::now() - start_).count();
+    stage_.allocations = PipelineStats::allocations() - allocationsAtStart_;
+    stage_.peakRssKb = PipelineStats::peakRssKb();
+    stats_->add(std::move(stage_));
+}
+
+void ScopedStage::bytesOutFile(const std::filesystem::path& path) {
+    if (stats_ == nullptr) {
+        return;
+    }
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(path, ec);
+    if (!ec) {
+        stage_.bytesOut += size;
+    }
+}
@@ -0,0 +1,94 @@
+#ifndef PIPELINESTATS_H
+#define PIPELINESTATS_H
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// What one pipeline stage did (--stats). Counts that do not apply to a stage stay 0.
+struct StageStats {
+    std::string name;
+    double wallMs = 0;
+    std::uint64_t bytesIn = 0;
+    std::uint64_t bytesOut = 0;
+    std::uint64_t tokens = 0;
+    std::uint64_t distinct = 0;
+    long peakRssKb = -1;          // process peak so far; -1 where getrusage() is missing
+    std::uint64_t allocations = 0; // operator new calls during the stage, all threads
+};
+
+// The stages of one run, in order.
+class PipelineStats {
+public:
+    void add(StageStats stage) { stages_.push_back(std::move(stage)); }
+    [[nodiscard]] const std::vector<StageStats>& stages() const noexcept { return stages_; }
+
+    // A table, or one JSON object with a "stages" array.
+    void print(std::ostream& os, bool json) const;
+
+    // Allocation counting. The program's operator new calls noteAllocation();
+    // it only counts after enableAllocationCounting(), which must happen before
+    // any other thread starts.
+    static void enableAllocationCounting() noexcept { countAllocations_ = true; }
+    static void noteAllocation() noexcept {
+        if (countAllocations_) {
+            allocations_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    [[nodiscard]] static std::uint64_t allocations() noexcept {
+        return allocations_.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] static long peakRssKb() noexcept;
+
+private:
+    std::vector<StageStats> stages_;
+    static inline bool countAllocations_ = false;
+    static inline std::atomic<std::uint64_t> allocations_{0};
+};
+
+// Times the enclosing scope as one stage and adds it to 'stats' on exit.
+// With stats == nullptr (no --stats) it never reads the clock: the constructor,
+// the setters and the destructor are a pointer test each.
+class ScopedStage {
+public:
+    ScopedStage(PipelineStats* stats, const char* name) : stats_(stats) {
+        if (stats_ != nullptr) {
+            begin(name);
+        }
+    }
+    ~ScopedStage() {
+        if (stats_ != nullptr) {
+            end();
+        }
+    }
+
+    ScopedStage(const ScopedStage&) = delete;
+    ScopedStage& operator=(const ScopedStage&) = delete;
+
+    void bytesIn(std::uint64_t bytes) noexcept { stage_.bytesIn = bytes; }
+    void bytesOut(std::uint64_t bytes) noexcept { stage_.bytesOut = bytes; }
+    void tokens(std::uint64_t count) noexcept { stage_.tokens = count; }
+    void distinct(std::uint64_t count) noexcept { stage_.distinct = count; }
+
+    // Add the size of a written file to bytesOut (skipped when stats are off)
+    void bytesOutFile(const std::filesystem::path& path);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    PipelineStats* stats_;
+    StageStats stage_;
+    Clock::time_point start_;
+    std::uint64_t allocationsAtStart_ = 0;
+
+    void begin(const char* name);
+    void end();
+};
+
+#endif //PIPELINESTATS_H
@@ -2,14 +2,16 @@
 #include "TreeNode.h"
 #include <vector>
 #include <iostream>
-#include <algorithm> // for std::sort, std::ranges
+#include <utility> // for std::swap
 
 // Constructor: takes an initial vector of nodes
 PriorityQueue::PriorityQueue(std::vector<TreeNode*> nodes) {
-    items_ = nodes; // Copies everything into items_ 1:1
+    items_ = std::move(nodes); // Take the vector over without copying
 
-    //from beginning to end of items_, go through and sorty by higherPriority
-    std::ranges::sort(items_, higherPriority);
+    // Bottom-up heapify: sift down every internal slot, last parent first (O(N))
+    for (std::size_t i = items_.size() / 2; i-- > 0; ) {
+        siftDown(i);
+    }
 }
 
 
@@ -38,13 +40,13 @@ bool PriorityQueue::empty() const noexcept {
 
 
 
-// Return the minimum element (items_.back()) or nullptr if empty
+// Return the minimum element (items_.front()) or nullptr if empty
 TreeNode* PriorityQueue::findMin() const noexcept {
     // If empty return nullptr
     if (items_.empty()) {
         return nullptr;
     }
-    return items_.back();
+    return items_.front();
 }
 
 
@@ -59,10 +61,9 @@ TreeNode* PriorityQueue::extractMin() noexcept {
     if (items_.empty()) {
         return nullptr;
     }
-    // Return the last element
-    TreeNode* min = items_.back();
-    // Remove the last element
-    items_.pop_back();
+    // The root is the minimum
+    TreeNode* min = items_.front();
+    deleteMin();
     return min;
 }
 
@@ -77,7 +78,12 @@ void PriorityQueue::deleteMin() noexcept {
     if (items_.empty()) {
         return;
     }
-    items_.pop_back(); 
+    // Move the last leaf to the root and let it sink back into place
+    items_.front() = items_.back();
+    items_.pop_back();
+    if (!items_.empty()) {
+        siftDown(0);
+    }
 }
 
 
@@ -86,12 +92,10 @@ void PriorityQueue::deleteMin() noexcept {
 
 
 
-// Insert a node while keeping the vector sorted
+// Insert a node while keeping the heap invariant
 void PriorityQueue::insert(TreeNode* node) {
     items_.push_back(node);
-
-    // Sort the items_ vector by higherPriority, ranges is just (.begin(), .end(), higherPriority);
-    std::ranges::sort(items_, higherPriority);
+    siftUp(items_.size() - 1);
 }
 
 
@@ -102,9 +106,9 @@ void PriorityQueue::insert(TreeNode* node) {
 
 // Print the contents of the queue for debugging
 void PriorityQueue::print(std::ostream& os) const {
-    os << "PriorityQueue contents (front = lowest priority):\n";
+    os << "PriorityQueue contents (heap order, front = min):\n";
     for (const auto& node : items_) {
-        os << "{" << node->key_word << ": " << node->freq << "}\n";
+        os << "{" << node->key_word << " #" << node->rank << ": " << node->freq << "}\n";
     }
 }
 
@@ -113,12 +117,50 @@ void PriorityQueue::print(std::ostream& os) const {
 
 
 
-// Static comparator: determines ordering (freq desc, key_word asc)
+// Static comparator: determines ordering (freq asc, rank desc)
 bool PriorityQueue::higherPriority(const TreeNode* a, const TreeNode* b) noexcept {
     if (a->freq != b->freq) {
-        return a->freq > b->freq; // Higher Frequency First
+        return a->freq < b->freq; // Lower Frequency leaves first
+    }
+    return a->rank > b->rank; // Tie: larger rank (later word) leaves first
+}
+
+
+
+
+
+
+// Move items_[i] up while it beats its parent
+void PriorityQueue::siftUp(std::size_t i) noexcept {
+    while (i > 0) {
+        const std::size_t parent = (i - 1) / 2;
+        if (!higherPriority(items_[i], items_[parent])) {
+            break;
+        }
+        std::swap(items_[i], items_[parent]);
+        i = parent;
+    }
+}
+
+// Move items_[i] down while one of its children beats it
+void PriorityQueue::siftDown(std::size_t i) noexcept {
+    const std::size_t n = items_.size();
+    for (;;) {
+        const std::size_t left = 2 * i + 1;
+        if (left >= n) {
+            break;
+        }
+        // Pick the child that leaves first
+        std::size_t best = left;
+        if (left + 1 < n && higherPriority(items_[left + 1], items_[left])) {
+            best = left + 1;
+        }
+        if (!higherPriority(items_[best], items_[i])) {
+            break;
+        }
+        std::swap(items_[i], items_[best]);
+        i = best;
     }
-    return a->key_word < b->key_word; // Tie: smaller key_word first
 }
 
 
@@ -127,12 +169,12 @@ bool PriorityQueue::higherPriority(const TreeNode* a, const TreeNode* b) noexcep
 
 
 
-// Optional check to verify the vector is sorted (for debugging)
-bool PriorityQueue::isSorted() const {
+// Optional check to verify the heap invariant (for debugging)
+bool PriorityQueue::isHeap() const {
 
-    // Itereate through the items_ vector and make sure each element is greater than the next element using higherPriority
-    for (size_t i = 0; i < items_.size() - 1; ++i) {
-        if (!higherPriority(items_[i], items_[i + 1])) {
+    // Every child must not have higher priority than its parent
+    for (std::size_t i = 1; i < items_.size(); ++i) {
+        if (higherPriority(items_[i], items_[(i - 1) / 2])) {
             return false;
         }
     }
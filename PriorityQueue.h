@@ -14,33 +14,39 @@
 class PriorityQueue {
 public:
     // Non‑owning: does NOT delete the TreeNode* it stores.
-    // The constructor takes an initial set of leaves and sorts them internally.
+    // The constructor takes an initial set of leaves and heapifies them in O(N).
     explicit PriorityQueue(std::vector<TreeNode*> nodes);
     ~PriorityQueue() = default;
 
     [[nodiscard]] std::size_t size() const noexcept;
     [[nodiscard]] bool empty() const noexcept;
 
-    // Min accessors (MIN = items_.back() under our ordering)
+    // Min accessors (MIN = items_.front(), the root of the heap)
     [[nodiscard]] TreeNode* findMin() const noexcept;   // nullptr if empty
-    TreeNode* extractMin() noexcept;                    // remove+return min, or nullptr
+    TreeNode* extractMin() noexcept;                    // remove+return min, or nullptr (O(log N))
     void deleteMin() noexcept;                          // remove min if present
 
-    // Insert while maintaining the invariant (O(N) due to shifting)
+    // Insert while maintaining the heap invariant (O(log N) sift-up)
     // Stores the pointer without taking ownership.
     void insert(TreeNode* node);
 
     // Debug printing
     void print(std::ostream& os = std::cout) const;
 
+    // Ordering shared with HuffmanTree's two-queue merge:
+    // true if 'a' leaves the queue before 'b' (freq asc, then rank desc).
+    // Ranks are unique, so this is a strict total order and the merge is deterministic.
+    static bool higherPriority(const TreeNode* a, const TreeNode* b) noexcept;
+
 private:
-    // Invariant: items_ is kept sorted by HigherPriority(a,b)
-    // i.e., (freq desc, key_word asc). Therefore the MIN is items_.back().
+    // Invariant: items_ is a binary min-heap under higherPriority,
+    // i.e. no child has higher priority than its parent.
     // Ownership: items_ does NOT own the pointers.
     std::vector<TreeNode*> items_;
 
-    static bool higherPriority(const TreeNode* a, const TreeNode* b) noexcept; // a before b?
-    bool isSorted() const; // for assertions/tests only
+    void siftUp(std::size_t i) noexcept;
+    void siftDown(std::size_t i) noexcept;
+    bool isHeap() const; // for assertions/tests only
 };
 
 
@@ -0,0 +1,110 @@
+#include "ScanKernels.h"
+#include <cstdint>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define HAVE_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+#ifdef HAVE_X86_KERNELS
+
+// A byte is a letter when (byte | 0x20) is in 'a'..'z'. SSE/AVX only compare
+// signed bytes, so shift 'a' down to -128: letters land on -128..-103 and
+// everything else (including bytes >= 0x80) lands above.
+constexpr char LETTER_SHIFT = static_cast<char>(128 - 'a');
+constexpr char LETTER_LIMIT = static_cast<char>(-128 + 26);
+
+BlockMasks classifySse2(const char* block) {
+    const __m128i caseBit = _mm_set1_epi8(0x20);
+    const __m128i shift = _mm_set1_epi8(LETTER_SHIFT);
+    const __m128i limit = _mm_set1_epi8(LETTER_LIMIT);
+    const __m128i apostrophe = _mm_set1_epi8('\'');
+
+    BlockMasks masks{0, 0};
+    for (int i = 0; i < 4; ++i) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16 * i));
+        const __m128i folded = _mm_add_epi8(_mm_or_si128(v, caseBit), shift);
+        const auto letters = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmplt_epi8(folded, limit)));
+        const auto quotes = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, apostrophe)));
+        masks.letters |= static_cast<std::uint64_t>(letters) << (16 * i);
+        masks.apostrophes |= static_cast<std::uint64_t>(quotes) << (16 * i);
+    }
+    return masks;
+}
+
+__attribute__((target("avx2")))
+BlockMasks classifyAvx2(const char* block) {
+    const __m256i caseBit = _mm256_set1_epi8(0x20);
+    const __m256i shift = _mm256_set1_epi8(LETTER_SHIFT);
+    const __m256i limit = _mm256_set1_epi8(LETTER_LIMIT);
+    const __m256i apostrophe = _mm256_set1_epi8('\'');
+
+    BlockMasks masks{0, 0};
+    for (int i = 0; i < 2; ++i) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + 32 * i));
+        const __m256i folded = _mm256_add_epi8(_mm256_or_si256(v, caseBit), shift);
+        // limit > folded  <=>  folded < limit
+        const auto letters = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpgt_epi8(limit, folded)));
+        const auto quotes = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, apostrophe)));
+        masks.letters |= static_cast<std::uint64_t>(letters) << (32 * i);
+        masks.apostrophes |= static_cast<std::uint64_t>(quotes) << (32 * i);
+    }
+    return masks;
+}
+
+#endif
+
+bool cpuHasAvx2() {
+#ifdef HAVE_X86_KERNELS
+    static const bool has = __builtin_cpu_supports("avx2");
+    return has;
+#else
+    return false;
+#endif
+}
+
+} // End of namespace
+
+ScanKernel resolveScanKernel(ScanKernel requested) {
+#ifdef HAVE_X86_KERNELS
+    switch (requested) {
+        case ScanKernel::AUTO:
+            return cpuHasAvx2() ? ScanKernel::AVX2 : ScanKernel::SSE2;
+        case ScanKernel::AVX2:
+            return cpuHasAvx2() ? ScanKernel::AVX2 : ScanKernel::SSE2;
+        default:
+            return requested;
+    }
+#else
+    (void) requested;
+    return ScanKernel::SCALAR;
+#endif
+}
+
+ClassifyFn blockClassifier(ScanKernel kernel) {
+#ifdef HAVE_X86_KERNELS
+    switch (resolveScanKernel(kernel)) {
+        case ScanKernel::AVX2:
+            return classifyAvx2;
+        case ScanKernel::SSE2:
+            return classifySse2;
+        default:
+            return nullptr;
+    }
+#else
+    (void) kernel;
+    return nullptr;
+#endif
+}
+
+const char* scanKernelName(ScanKernel kernel) {
+    switch (kernel) {
+        case ScanKernel::AUTO:   return "auto";
+        case ScanKernel::SCALAR: return "scalar";
+        case ScanKernel::SSE2:   return "sse2";
+        case ScanKernel::AVX2:   return "avx2";
+    }
+    return "unknown";
+}
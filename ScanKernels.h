@@ -0,0 +1,32 @@
+#ifndef SCANKERNELS_H
+#define SCANKERNELS_H
+
+#pragma once
+#include <cstdint>
+
+// Which code path Scanner uses to find token boundaries.
+//   SCALAR - one class-table lookup per byte (portable reference path)
+//   SSE2   - classify 16 bytes per instruction
+//   AVX2   - classify 32 bytes per instruction
+//   AUTO   - the fastest kernel this CPU supports, picked once at runtime
+enum class ScanKernel { AUTO, SCALAR, SSE2, AVX2 };
+
+// Classification of one 64-byte block: bit i describes byte i.
+struct BlockMasks {
+    std::uint64_t letters;      // ASCII A-Z / a-z
+    std::uint64_t apostrophes;  // '\''
+    // every other bit is a separator (including every non-ASCII byte)
+};
+
+// Classifies the 64 bytes at 'block' (all 64 must be readable).
+using ClassifyFn = BlockMasks (*)(const char* block);
+
+// Resolve AUTO to a concrete kernel, and unsupported kernels to SCALAR.
+ScanKernel resolveScanKernel(ScanKernel requested);
+
+// Block classifier for a SIMD kernel; nullptr for SCALAR (it has no block form).
+ClassifyFn blockClassifier(ScanKernel kernel);
+
+const char* scanKernelName(ScanKernel kernel);
+
+#endif //SCANKERNELS_H
@@ -7,7 +7,15 @@
 #include <utility>
 #include <iostream>
 #include <fstream>
+#include <array>
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <bit>
 #include "utils.hpp"
+#include "MappedFile.h"
+#include "ThreadPool.h"
+#include "StringInterner.h"
 
 /* Helper functions */
 
@@ -62,6 +70,162 @@ inline bool skip_to_next_letter(std::istream& in, char& out_first) {
     return false;
 }
 
+// Character classes for the buffer scanner, one lookup per byte:
+//   'a'..'z' -> ASCII letter (value is the lowercased letter)
+//   '\''     -> apostrophe
+//   0        -> separator (digits, punctuation, whitespace, every non-ASCII byte)
+constexpr std::array<char, 256> makeCharClass() {
+    std::array<char, 256> table{};
+    for (int c = 'a'; c <= 'z'; ++c) {
+        table[c] = static_cast<char>(c);
+        table[c - 'a' + 'A'] = static_cast<char>(c);
+    }
+    table['\''] = '\'';
+    return table;
+}
+
+constexpr std::array<char, 256> CHAR_CLASS = makeCharClass();
+
+inline char char_class(char c) {
+    return CHAR_CLASS[static_cast<unsigned char>(c)];
+}
+
+inline bool is_letter_class(char cls) {
+    return cls >= 'a'; // every letter class is 'a'..'z'; apostrophe and 0 are below
+}
+
+// Scalar path: one class-table lookup per byte.
+template <typename Emit>
+void scanScalar(std::string_view text, Emit&& emit) {
+    const char* p = text.data();
+    const std::size_t n = text.size();
+    std::size_t i = 0;
+
+    for (;;) {
+        // Skip separators (and apostrophes not inside a word) up to the next letter
+        while (i < n && !is_letter_class(char_class(p[i]))) {
+            ++i;
+        }
+        if (i == n) {
+            break;
+        }
+
+        // Extend over letters, and over apostrophes that are followed by a letter
+        const std::size_t start = i;
+        while (i < n) {
+            const char cls = char_class(p[i]);
+            if (is_letter_class(cls)) {
+                ++i;
+            } else if (cls == '\'' && i + 1 < n && is_letter_class(char_class(p[i + 1]))) {
+                i += 2;
+            } else {
+                break;
+            }
+        }
+        emit(start, i);
+    }
+}
+
+// SIMD path: classify 64 bytes at a time into bitmasks, then jump between
+// token starts and ends with count-trailing-zeros instead of testing bytes.
+//
+// Byte i belongs to a word when it is a letter, or an apostrophe with a letter
+// on both sides:   word = L | (A & (L << 1) & (L >> 1))
+// (bit shifts are toward higher/lower byte positions; the bits that fall off a
+// block edge come from the neighbouring blocks). Tokens are the runs of 1s.
+template <typename Emit>
+void scanBlocks(std::string_view text, ClassifyFn classify, Emit&& emit) {
+    const char* p = text.data();
+    const std::size_t n = text.size();
+    if (n == 0) {
+        return;
+    }
+
+    // The last partial block is classified from a zero-padded copy (zero is a separator)
+    char tail[64];
+    auto classifyAt = [&](std::size_t offset) {
+        if (offset + 64 <= n) {
+            return classify(p + offset);
+        }
+        std::fill(std::begin(tail), std::end(tail), '\0');
+        std::copy(p + offset, p + n, tail);
+        return classify(tail);
+    };
+
+    BlockMasks current = classifyAt(0);
+    std::uint64_t letterBefore = 0; // bit 63 of the previous block's letters
+    bool inToken = false;
+    std::size_t tokenStart = 0;
+
+    for (std::size_t base = 0; base < n; base += 64) {
+        const BlockMasks next = base + 64 < n ? classifyAt(base + 64) : BlockMasks{0, 0};
+        const std::uint64_t letters = current.letters;
+        const std::uint64_t before = (letters << 1) | letterBefore;
+        const std::uint64_t after = (letters >> 1) | (next.letters << 63);
+        const std::uint64_t word = letters | (current.apostrophes & before & after);
+
+        int pos = 0;
+        for (;;) {
+            if (!inToken) {
+                const std::uint64_t starts = word & (~std::uint64_t{0} << pos);
+                if (starts == 0) {
+                    break;
+                }
+                pos = std::countr_zero(starts);
+                tokenStart = base + static_cast<std::size_t>(pos);
+                inToken = true;
+            }
+            const std::uint64_t gaps = ~word & (~std::uint64_t{0} << pos);
+            if (gaps == 0) {
+                break; // token continues into the next block
+            }
+            pos = std::countr_zero(gaps);
+            emit(tokenStart, base + static_cast<std::size_t>(pos));
+            inToken = false;
+        }
+
+        letterBefore = letters >> 63;
+        current = next;
+    }
+    if (inToken) {
+        emit(tokenStart, n);
+    }
+}
+
+// Run the scan path for 'kernel' over 'text'
+template <typename Emit>
+void scanWith(std::string_view text, ScanKernel kernel, Emit&& emit) {
+    if (ClassifyFn classify = blockClassifier(kernel); classify != nullptr) {
+        scanBlocks(text, classify, emit);
+    } else {
+        scanScalar(text, emit);
+    }
+}
+
+// Copy a token's bytes into 'w' (already sized), lowercased
+inline void lowercaseInto(std::string& w, const char* src) {
+    for (std::size_t k = 0; k < w.size(); ++k) {
+        w[k] = static_cast<char>(src[k] | 0x20); // letters only; '\'' | 0x20 == '\''
+    }
+}
+
+// Cut 'text' into about 'pieces' chunks [cuts[i], cuts[i + 1]), each cut moved
+// forward onto a separator byte so no token spans two chunks
+std::vector<std::size_t> cutAtSeparators(std::string_view text, std::size_t pieces) {
+    std::vector<std::size_t> cuts{0};
+    for (std::size_t k = 1; k < pieces; ++k) {
+        std::size_t cut = std::max(cuts.back(), text.size() * k / pieces);
+        while (cut < text.size() && char_class(text[cut]) != 0) {
+            ++cut;
+        }
+        if (cut > cuts.back() && cut < text.size()) {
+            cuts.push_back(cut);
+        }
+    }
+    cuts.push_back(text.size());
+    return cuts;
+}
+
 } // End of namespace
 
 
@@ -82,6 +246,246 @@ error_type Scanner::tokenize(std::vector<std::string> &words) {
         return FILE_NOT_FOUND;
     }
 
+    MappedFile file;
+    if (error_type err = file.open(inputPath_); err != NO_ERROR) {
+        return err;
+    }
+
+    words.clear();
+    tokenizeBuffer(file.view(), words);
+    return NO_ERROR;
+}
+
+/**
+ * Buffer scanner: same rules as readWord(), without the per-byte stream calls.
+ *
+ * A token is a run of ASCII letters in which an apostrophe is kept only when a
+ * letter follows it (and a letter precedes it, since the run starts with one).
+ * Both scan paths below report each token as a [start, end) byte range; the
+ * caller builds the lowercased string in one allocation.
+ */
+void Scanner::tokenizeBuffer(std::string_view text, std::vector<std::string>& words, ScanKernel kernel) {
+    const char* p = text.data();
+    scanWith(text, kernel, [p, &words](std::size_t start, std::size_t end) {
+        lowercaseInto(words.emplace_back(end - start, '\0'), p + start);
+    });
+}
+
+// Tokenize into memory, scanning chunks of the file on the pool
+error_type Scanner::tokenize(std::vector<std::string> &words, ThreadPool& pool) {
+    namespace fs = std::filesystem;
+
+    if (inputPath_.has_parent_path() && !fs::exists(inputPath_.parent_path())) {
+        return DIR_NOT_FOUND;
+    }
+    if (!fs::exists(inputPath_)) {
+        return FILE_NOT_FOUND;
+    }
+
+    MappedFile file;
+    if (error_type err = file.open(inputPath_); err != NO_ERROR) {
+        return err;
+    }
+
+    words.clear();
+    tokenizeBufferParallel(file.view(), words, pool);
+    return NO_ERROR;
+}
+
+/**
+ * Chunked scan. A token is made only of letters and apostrophes, so a byte of
+ * any other class can never be inside one. Moving each cut forward to such a
+ * byte fixes up the chunk edges: a word (or "don't"-style apostrophe pair)
+ * that would have been split lands entirely in the earlier chunk, and an
+ * apostrophe right before the cut is followed by a separator in both the
+ * chunk and the whole text, so it is dropped either way.
+ */
+void Scanner::tokenizeBufferParallel(std::string_view text, std::vector<std::string>& words,
+                                     ThreadPool& pool, ScanKernel kernel) {
+    const std::size_t pieces = std::min<std::size_t>(pool.size(), text.size() / MIN_CHUNK_BYTES);
+    if (pieces <= 1) {
+        tokenizeBuffer(text, words, kernel);
+        return;
+    }
+
+    // Cut points, each moved forward onto a separator byte
+    const std::vector<std::size_t> cuts = cutAtSeparators(text, pieces);
+
+    // Pass 1: count each chunk's tokens, so every chunk knows where its
+    // tokens start in 'words' (no per-chunk vectors to grow and join)
+    const std::size_t chunks = cuts.size() - 1;
+    std::vector<std::size_t> offsets(chunks + 1, 0);
+    pool.parallelFor(chunks, [&](std::size_t i) {
+        std::size_t count = 0;
+        scanWith(text.substr(cuts[i], cuts[i + 1] - cuts[i]), kernel,
+                 [&count](std::size_t, std::size_t) { ++count; });
+        offsets[i + 1] = count;
+    });
+    offsets[0] = words.size();
+    for (std::size_t i = 0; i < chunks; ++i) {
+        offsets[i + 1] += offsets[i];
+    }
+
+    // Pass 2: each chunk fills its own slice of 'words', in order
+    words.resize(offsets[chunks]);
+    pool.parallelFor(chunks, [&](std::size_t i) {
+        const std::string_view chunk = text.substr(cuts[i], cuts[i + 1] - cuts[i]);
+        std::size_t slot = offsets[i];
+        scanWith(chunk, kernel, [&](std::size_t start, std::size_t end) {
+            std::string& w = words[slot++];
+            w.resize(end - start);
+            lowercaseInto(w, chunk.data() + start);
+        });
+    });
+}
+
+// Tokenize into word IDs
+error_type Scanner::tokenize(std::vector<std::uint32_t>& ids, StringInterner& interner) {
+    namespace fs = std::filesystem;
+
+    if (inputPath_.has_parent_path() && !fs::exists(inputPath_.parent_path())) {
+        return DIR_NOT_FOUND;
+    }
+    if (!fs::exists(inputPath_)) {
+        return FILE_NOT_FOUND;
+    }
+
+    MappedFile file;
+    if (error_type err = file.open(inputPath_); err != NO_ERROR) {
+        return err;
+    }
+
+    ids.clear();
+    tokenizeBuffer(file.view(), ids, interner);
+    return NO_ERROR;
+}
+
+void Scanner::tokenizeBuffer(std::string_view text, std::vector<std::uint32_t>& ids,
+                             StringInterner& interner, ScanKernel kernel) {
+    // One scratch string for the lowercased token; the interner copies it
+    // only the first time the word is seen
+    const char* p = text.data();
+    std::string w;
+    scanWith(text, kernel, [&](std::size_t start, std::size_t end) {
+        w.resize(end - start);
+        lowercaseInto(w, p + start);
+        ids.push_back(interner.intern(w));
+    });
+}
+
+// Tokenize into word IDs, scanning chunks of the file on the pool
+error_type Scanner::tokenize(std::vector<std::uint32_t>& ids, StringInterner& interner, ThreadPool& pool) {
+    namespace fs = std::filesystem;
+
+    if (inputPath_.has_parent_path() && !fs::exists(inputPath_.parent_path())) {
+        return DIR_NOT_FOUND;
+    }
+    if (!fs::exists(inputPath_)) {
+        return FILE_NOT_FOUND;
+    }
+
+    MappedFile file;
+    if (error_type err = file.open(inputPath_); err != NO_ERROR) {
+        return err;
+    }
+
+    ids.clear();
+    tokenizeBufferParallel(file.view(), ids, interner, pool);
+    return NO_ERROR;
+}
+
+void Scanner::tokenizeBufferParallel(std::string_view text, std::vector<std::uint32_t>& ids,
+                                     StringInterner& interner, ThreadPool& pool, ScanKernel kernel) {
+    const std::size_t pieces = std::min<std::size_t>(pool.size(), text.size() / MIN_CHUNK_BYTES);
+    if (pieces <= 1) {
+        tokenizeBuffer(text, ids, interner, kernel);
+        return;
+    }
+    const std::vector<std::size_t> cuts = cutAtSeparators(text, pieces);
+    const std::size_t chunks = cuts.size() - 1;
+
+    // Pass 1: each chunk scans into its own interner and local IDs
+    std::vector<StringInterner> local(chunks);
+    std::vector<std::vector<std::uint32_t>> localIds(chunks);
+    pool.parallelFor(chunks, [&](std::size_t i) {
+        tokenizeBuffer(text.substr(cuts[i], cuts[i + 1] - cuts[i]), localIds[i], local[i], kernel);
+    });
+
+    // Merge vocabularies in chunk order. A chunk's local IDs are first-seen
+    // within the chunk, so this hands out global IDs in first-seen order of
+    // the whole text, exactly like the serial scan.
+    std::vector<std::vector<std::uint32_t>> remap(chunks);
+    std::vector<std::size_t> offsets(chunks + 1, ids.size());
+    for (std::size_t i = 0; i < chunks; ++i) {
+        remap[i].reserve(local[i].size());
+        for (std::string_view word : local[i].words()) {
+            remap[i].push_back(interner.intern(word));
+        }
+        offsets[i + 1] = offsets[i] + localIds[i].size();
+    }
+
+    // Pass 2: each chunk writes its translated IDs into its own slice
+    ids.resize(offsets[chunks]);
+    pool.parallelFor(chunks, [&](std::size_t i) {
+        std::size_t slot = offsets[i];
+        for (std::uint32_t id : localIds[i]) {
+            ids[slot++] = remap[i][id];
+        }
+    });
+}
+
+// Stream every token to 'sink', a window of the mapped file at a time
+error_type Scanner::scan(TokenSink& sink) {
+    namespace fs = std::filesystem;
+
+    if (inputPath_.has_parent_path() && !fs::exists(inputPath_.parent_path())) {
+        return DIR_NOT_FOUND;
+    }
+    if (!fs::exists(inputPath_)) {
+        return FILE_NOT_FOUND;
+    }
+
+    MappedFile file;
+    if (error_type err = file.open(inputPath_); err != NO_ERROR) {
+        return err;
+    }
+
+    // Windows end on a separator byte, like the parallel chunks
+    const std::string_view text = file.view();
+    std::size_t start = 0;
+    while (start < text.size()) {
+        std::size_t end = std::min(text.size(), start + STREAM_WINDOW_BYTES);
+        while (end < text.size() && char_class(text[end]) != 0) {
+            ++end;
+        }
+        scanBuffer(text.substr(start, end - start), sink);
+        file.release(start, end - start);
+        start = end;
+    }
+    return NO_ERROR;
+}
+
+void Scanner::scanBuffer(std::string_view text, TokenSink& sink, ScanKernel kernel) {
+    const char* p = text.data();
+    std::string w;
+    scanWith(text, kernel, [&](std::size_t start, std::size_t end) {
+        w.resize(end - start);
+        lowercaseInto(w, p + start);
+        sink.token(w);
+    });
+}
+
+// Tokenize with the original per-character stream reader
+error_type Scanner::tokenizeStream(std::vector<std::string> &words) {
+    namespace fs = std::filesystem;
+
+    if (inputPath_.has_parent_path() && !fs::exists(inputPath_.parent_path())) {
+        return DIR_NOT_FOUND;
+    }
+    if (!fs::exists(inputPath_)) {
+        return FILE_NOT_FOUND;
+    }
+
     std::ifstream in(inputPath_, std::ios::binary);
     if (!in) {
         return UNABLE_TO_OPEN_FILE;
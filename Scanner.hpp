@@ -4,11 +4,25 @@
 
 #ifndef IMPLEMENTATION_FILETOWORDS_HPP
 #define IMPLEMENTATION_FILETOWORDS_HPP
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <filesystem>
 
 #include "utils.hpp"
+#include "ScanKernels.h"
+
+class ThreadPool;
+class StringInterner;
+
+// Receives tokens from Scanner::scan() one at a time, in input order. The view
+// holds the lowercased token and is only valid during the call.
+class TokenSink {
+public:
+    virtual ~TokenSink() = default;
+    virtual void token(std::string_view word) = 0;
+};
 
 
 class Scanner {
@@ -16,8 +30,54 @@ public:
     explicit Scanner(std::filesystem::path inputPath);
 
     // Tokenize into memory (according to the Rules in this section).
+    // The input file is memory-mapped and scanned as one buffer.
     error_type tokenize(std::vector<std::string>& words);
 
+    // Tokenize text that is already in memory (same rules as tokenize()), appending to 'words'.
+    // 'kernel' picks the boundary-detection code path; every kernel yields the same tokens.
+    static void tokenizeBuffer(std::string_view text, std::vector<std::string>& words,
+                               ScanKernel kernel = ScanKernel::AUTO);
+
+    // Parallel versions: the text is cut into one chunk per pool thread (chunks
+    // under MIN_CHUNK_BYTES are not worth a thread), every cut is moved forward
+    // to the next separator byte so no token straddles two chunks. The chunks are
+    // scanned concurrently twice: once to count tokens (giving each chunk its
+    // offset in 'words'), once to fill them in place. The result is identical to
+    // the serial tokenize().
+    error_type tokenize(std::vector<std::string>& words, ThreadPool& pool);
+    static void tokenizeBufferParallel(std::string_view text, std::vector<std::string>& words,
+                                       ThreadPool& pool, ScanKernel kernel = ScanKernel::AUTO);
+
+    static constexpr std::size_t MIN_CHUNK_BYTES = 1 << 18;
+
+    // Interned versions: instead of one std::string per token, each distinct
+    // word is stored once in 'interner' and 'ids' gets the word's ID per token.
+    // ids[i] names the same word tokenize() would have put in words[i].
+    error_type tokenize(std::vector<std::uint32_t>& ids, StringInterner& interner);
+    static void tokenizeBuffer(std::string_view text, std::vector<std::uint32_t>& ids,
+                               StringInterner& interner, ScanKernel kernel = ScanKernel::AUTO);
+
+    // Parallel: every chunk interns into its own table, then the chunks' words
+    // are merged into 'interner' in chunk order and their IDs remapped, so the
+    // IDs match the serial scan's first-seen numbering.
+    error_type tokenize(std::vector<std::uint32_t>& ids, StringInterner& interner, ThreadPool& pool);
+    static void tokenizeBufferParallel(std::string_view text, std::vector<std::uint32_t>& ids,
+                                       StringInterner& interner, ThreadPool& pool,
+                                       ScanKernel kernel = ScanKernel::AUTO);
+
+    // Streaming: send every token of the input file to 'sink' and keep none.
+    // The mapped file is scanned STREAM_WINDOW_BYTES at a time (each window
+    // ends on a separator byte, so no token is split), and each finished
+    // window's pages are released, so memory is bounded by what the sink keeps.
+    error_type scan(TokenSink& sink);
+    static void scanBuffer(std::string_view text, TokenSink& sink, ScanKernel kernel = ScanKernel::AUTO);
+
+    static constexpr std::size_t STREAM_WINDOW_BYTES = 4 << 20;
+
+    // The original reader: pulls each byte through std::istream get()/peek().
+    // Produces the same tokens as tokenize(); kept as the reference for benchmarks.
+    error_type tokenizeStream(std::vector<std::string>& words);
+
     // Tokenize and also write one token per line to 'outputFile' (e.g., <base>.tokens).
     // This overload should internally call the in‑memory tokenize() to avoid duplicate logic.
     error_type tokenize(std::vector<std::string>& words,
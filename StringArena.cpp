@@ -0,0 +1,30 @@
+#include "StringArena.h"
+#include <algorithm>
+#include <cstring>
+
+StringArena::StringArena(std::size_t blockBytes)
+    : blockBytes_(std::max<std::size_t>(blockBytes, 64)) {}
+
+std::string_view StringArena::store(std::string_view s) {
+    if (s.size() > left_) {
+        // Start a new block (an oversized string gets a block of its own)
+        const std::size_t bytes = std::max(blockBytes_, s.size());
+        blocks_.push_back(std::make_unique<char[]>(bytes));
+        next_ = blocks_.back().get();
+        left_ = bytes;
+    }
+    char* copy = next_;
+    std::memcpy(copy, s.data(), s.size());
+    next_ += s.size();
+    left_ -= s.size();
+    used_ += s.size();
+    return {copy, s.size()};
+}
+
+std::size_t StringArena::bytesUsed() const noexcept {
+    return used_;
+}
+
+std::size_t StringArena::blockCount() const noexcept {
+    return blocks_.size();
+}
@@ -0,0 +1,36 @@
+#ifndef STRINGARENA_H
+#define STRINGARENA_H
+
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// Append-only storage for strings. Copies are packed into large blocks, and a
+// returned string_view stays valid (and never moves) until the arena is
+// destroyed, so tables can key on views instead of owning std::strings.
+class StringArena {
+public:
+    explicit StringArena(std::size_t blockBytes = 64 * 1024);
+
+    StringArena(const StringArena&) = delete;
+    StringArena& operator=(const StringArena&) = delete;
+    StringArena(StringArena&&) noexcept = default;
+    StringArena& operator=(StringArena&&) noexcept = default;
+
+    // Copy 's' into the arena and return a view of the copy.
+    std::string_view store(std::string_view s);
+
+    [[nodiscard]] std::size_t bytesUsed() const noexcept;
+    [[nodiscard]] std::size_t blockCount() const noexcept;
+
+private:
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    std::size_t blockBytes_;
+    char* next_ = nullptr;     // free space in the newest block
+    std::size_t left_ = 0;
+    std::size_t used_ = 0;
+};
+
+#endif //STRINGARENA_H
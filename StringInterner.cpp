@@ -0,0 +1,51 @@
+#include "StringInterner.h"
+#include "Hash.h"
+
+namespace {
+constexpr std::size_t INITIAL_SLOTS = 1024;
+}
+
+StringInterner::StringInterner() : slots_(INITIAL_SLOTS) {}
+
+std::uint32_t StringInterner::intern(std::string_view word) {
+    const std::uint64_t hash = hashBytes(word);
+    const auto hashLow = static_cast<std::uint32_t>(hash);
+    const std::size_t mask = slots_.size() - 1;
+
+    for (std::size_t i = hash & mask; ; i = (i + 1) & mask) {
+        Slot& slot = slots_[i];
+        if (slot.idPlusOne == 0) {
+            // New word: next dense ID, bytes copied into the arena
+            const auto id = static_cast<std::uint32_t>(words_.size());
+            slot.idPlusOne = id + 1;
+            slot.hashLow = hashLow;
+            words_.push_back(arena_.store(word));
+            hashes_.push_back(hash);
+            // Keep the load factor at or below 1/2 so probe runs stay short
+            if (words_.size() * 2 > slots_.size()) {
+                grow();
+            }
+            return id;
+        }
+        if (slot.hashLow == hashLow && words_[slot.idPlusOne - 1] == word) {
+            return slot.idPlusOne - 1;
+        }
+    }
+}
+
+// Double the table, re-placing IDs by their cached hashes
+void StringInterner::grow() {
+    std::vector<Slot> old(slots_.size() * 2);
+    old.swap(slots_);
+    const std::size_t mask = slots_.size() - 1;
+    for (const Slot& slot : old) {
+        if (slot.idPlusOne == 0) {
+            continue;
+        }
+        std::size_t i = hashes_[slot.idPlusOne - 1] & mask;
+        while (slots_[i].idPlusOne != 0) {
+            i = (i + 1) & mask;
+        }
+        slots_[i] = slot;
+    }
+}
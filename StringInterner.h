@@ -0,0 +1,48 @@
+#ifndef STRINGINTERNER_H
+#define STRINGINTERNER_H
+
+#pragma once
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "StringArena.h"
+
+// Gives every distinct word a dense ID: 0, 1, 2, ... in first-seen order.
+// Each word's bytes are stored once (in a StringArena), so a token stream can
+// be kept as a std::vector<std::uint32_t> and every later table indexed by ID.
+class StringInterner {
+public:
+    StringInterner();
+
+    StringInterner(const StringInterner&) = delete;
+    StringInterner& operator=(const StringInterner&) = delete;
+    StringInterner(StringInterner&&) noexcept = default;
+    StringInterner& operator=(StringInterner&&) noexcept = default;
+
+    // ID of 'word', adding it if this is the first time it is seen.
+    std::uint32_t intern(std::string_view word);
+
+    // The word behind 'id' (valid until the interner is destroyed).
+    [[nodiscard]] std::string_view word(std::uint32_t id) const noexcept { return words_[id]; }
+
+    // All words, indexed by ID.
+    [[nodiscard]] const std::vector<std::string_view>& words() const noexcept { return words_; }
+
+    [[nodiscard]] std::size_t size() const noexcept { return words_.size(); }
+
+private:
+    // Open addressing with linear probing. A slot holds ID + 1 (0 = free) and
+    // the low half of the word's hash, so most mismatches never touch the bytes.
+    struct Slot {
+        std::uint32_t idPlusOne = 0;
+        std::uint32_t hashLow = 0;
+    };
+    std::vector<Slot> slots_;                  // size is a power of two
+    std::vector<std::uint64_t> hashes_;        // full hash per ID, for growing
+    std::vector<std::string_view> words_;      // per ID, views into arena_
+    StringArena arena_;
+
+    void grow();
+};
+
+#endif //STRINGINTERNER_H
@@ -0,0 +1,146 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <utility>
+
+namespace {
+
+// Which worker of which pool the current thread is (none for outside threads)
+thread_local const ThreadPool* currentPool = nullptr;
+thread_local std::size_t currentWorker = 0;
+
+} // End of namespace
+
+ThreadPool::ThreadPool(unsigned threads) {
+    if (threads == 0) {
+        threads = hardwareThreads();
+    }
+    for (unsigned i = 0; i < threads; ++i) {
+        queues_.push_back(std::make_unique<TaskQueue>()); // workers' queues, then the shared one
+    }
+    for (unsigned i = 1; i < threads; ++i) {
+        workers_.emplace_back([this, i] { workerLoop(i - 1); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        stopping_ = true;
+    }
+    ready_.notify_all();
+    for (std::thread& t : workers_) {
+        t.join();
+    }
+}
+
+unsigned ThreadPool::size() const noexcept {
+    return static_cast<unsigned>(workers_.size()) + 1;
+}
+
+unsigned ThreadPool::hardwareThreads() noexcept {
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+// A worker pushes onto its own deque; any other thread onto the shared queue
+void ThreadPool::submit(std::function<void()> task) {
+    const std::size_t target = currentPool == this ? currentWorker : queues_.size() - 1;
+    {
+        // Counted under the sleep lock (and before the push, so the count
+        // never drops below zero) so a worker about to sleep cannot miss it
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        pending_.fetch_add(1);
+    }
+    {
+        std::lock_guard<std::mutex> lock(queues_[target]->mutex);
+        queues_[target]->tasks.push_back(std::move(task));
+    }
+    ready_.notify_one();
+}
+
+// Own deque newest-first, then the shared queue, then steal oldest-first
+// from the other workers, starting with the next one
+bool ThreadPool::tryTake(std::size_t self, std::function<void()>& task) {
+    {
+        TaskQueue& own = *queues_[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    const std::size_t workers = queues_.size() - 1; // (workers_ may still be growing)
+    for (std::size_t k = 0; k < workers; ++k) {
+        TaskQueue& victim = *queues_[k == 0 ? workers : (self + k) % workers];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(std::size_t self) {
+    currentPool = this;
+    currentWorker = self;
+    for (;;) {
+        std::function<void()> task;
+        if (tryTake(self, task)) {
+            pending_.fetch_sub(1);
+            task();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        ready_.wait(lock, [this] { return stopping_ || pending_.load() > 0; });
+        if (stopping_ && pending_.load() == 0) {
+            return; // stopping and nothing left to run
+        }
+    }
+}
+
+void ThreadPool::parallelFor(std::size_t count, const std::function<void(std::size_t)>& body) {
+    if (count == 0) {
+        return;
+    }
+    if (count == 1 || workers_.empty()) {
+        for (std::size_t i = 0; i < count; ++i) body(i);
+        return;
+    }
+
+    // Shared with the helpers: a helper that only starts after everything is
+    // done still finds valid state, sees no work left, and exits.
+    struct Loop {
+        std::function<void(std::size_t)> body;
+        std::size_t count;
+        std::atomic<std::size_t> next{0};
+        std::atomic<std::size_t> done{0};
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+    auto loop = std::make_shared<Loop>();
+    loop->body = body;
+    loop->count = count;
+
+    auto drain = [](Loop& l) {
+        for (std::size_t i; (i = l.next.fetch_add(1)) < l.count; ) {
+            l.body(i);
+            if (l.done.fetch_add(1) + 1 == l.count) {
+                std::lock_guard<std::mutex> lock(l.mutex);
+                l.finished.notify_all();
+            }
+        }
+    };
+
+    const std::size_t helpers = std::min(count - 1, workers_.size());
+    for (std::size_t h = 0; h < helpers; ++h) {
+        submit([loop, drain] { drain(*loop); });
+    }
+    drain(*loop);
+
+    std::unique_lock<std::mutex> lock(loop->mutex);
+    loop->finished.wait(lock, [&] { return loop->done.load() == count; });
+}
@@ -0,0 +1,63 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size work-stealing pool of worker threads.
+// A pool of N threads runs N-1 workers; the thread that calls parallelFor()
+// does its share of the work too instead of sleeping.
+//
+// Every worker has its own task deque. Tasks submitted from a worker (e.g.
+// by a parallelFor() nested inside another parallelFor() task) go on that
+// worker's deque: it takes them back newest-first, while idle workers steal
+// oldest-first from the other end. Tasks from outside the pool go on a
+// shared queue. So one big job's sub-tasks spread to whichever threads have
+// run out of their own work.
+class ThreadPool {
+public:
+    // threads == 0 means one per hardware thread.
+    explicit ThreadPool(unsigned threads = 0);
+    ~ThreadPool(); // finishes queued work, then joins the workers
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Total parallelism, counting the calling thread.
+    [[nodiscard]] unsigned size() const noexcept;
+
+    // Run body(0), body(1), ..., body(count - 1) on the pool and the calling
+    // thread; returns once every call has finished. Indices are handed out
+    // dynamically, so uneven pieces balance themselves. May be called from
+    // inside a body: the caller never waits on a piece nobody has started.
+    void parallelFor(std::size_t count, const std::function<void(std::size_t)>& body);
+
+    static unsigned hardwareThreads() noexcept;
+
+private:
+    struct TaskQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::thread> workers_;
+    std::vector<std::unique_ptr<TaskQueue>> queues_; // one per worker, then the shared one
+    std::atomic<std::size_t> pending_{0};            // queued, not yet taken
+    std::mutex sleepMutex_;
+    std::condition_variable ready_;
+    bool stopping_ = false;
+
+    void submit(std::function<void()> task);
+    bool tryTake(std::size_t self, std::function<void()>& task);
+    void workerLoop(std::size_t self);
+};
+
+#endif //THREADPOOL_H
@@ -7,6 +7,7 @@
 
 #pragma once
 #include <string>
+#include <string_view>
 
 
 // Hold data for each node in the binary search tree
@@ -14,13 +15,15 @@
 struct TreeNode {
     std::string key_word;
     int freq;
+    int rank;   // Huffman tie-break: word's lexicographic position (parent = min of children)
+    int height; // BinSearchTree: height of the subtree rooted here (leaf = 1)
     TreeNode* left;
     TreeNode* right;
 
 
     // Constructor Each node is initialized with at least a word.
-    explicit TreeNode(const std::string& w)
-    : key_word(w), freq(1), left(nullptr), right(nullptr) {}
+    explicit TreeNode(std::string_view w)
+    : key_word(w), freq(1), rank(0), height(1), left(nullptr), right(nullptr) {}
 };
 
 
@@ -0,0 +1,516 @@
+//
+// huffman_bench suite: per-stage timings as JSON, with a baseline check.
+//
+// Stages, each timed on its own with the others' inputs prepared beforehand:
+//   tokenize          Scanner::tokenizeBuffer over the whole corpus (in memory)
+//   bst_bulk_insert   BinSearchTree(AVL)::bulkInsert of every token
+//   priority_queue    heapify the leaves, then extractMin x2 / insert until one node is left
+//   build_from_counts HuffmanTree::buildFromCounts
+//   assign_codes      HuffmanTree::assignCodes
+//   write_header      HuffmanTree::writeHeader into a string
+//   encode            HuffmanTree::encode of the string tokens, binary, into a null stream
+//   static_two_pass   the whole static coder from tokens: count, build, header + binary encode
+//   adaptive_encode   AdaptiveHuffman, one pass over the tokens
+//   adaptive_decode   AdaptiveHuffman decode of that stream
+// The last three also report their output size ("output_bytes", "bits_per_token"),
+// so the static and adaptive coders can be compared on ratio as well as speed.
+//
+// Every stage runs once untimed, then --reps times; the JSON holds the median
+// and p95 (nearest rank) of those runs. One result per line, so a baseline
+// written by an earlier run can be read back without a JSON library.
+//
+
+#include "bench_suite.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <ostream>
+#include <random>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "AdaptiveHuffman.h"
+#include "BinSearchTree.h"
+#include "HuffmanTree.h"
+#include "MappedFile.h"
+#include "PriorityQueue.h"
+#include "Scanner.hpp"
+#include "TreeNode.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using Counts = std::vector<std::pair<std::string, int>>;
+
+struct ZipfSpec {
+    std::size_t megabytes;
+    std::size_t vocabulary;
+};
+
+struct SuiteOptions {
+    std::filesystem::path corpusDir = "input_output";
+    std::vector<ZipfSpec> zipf;     // empty = one 8 MB corpus of 50000 words
+    double exponent = 1.0;
+    int reps = 7;
+    std::string jsonPath;           // empty = stdout
+    std::string baselinePath;
+    double tolerance = 0.15;        // flag medians more than 15% above the baseline
+};
+
+struct Corpus {
+    std::string name;
+    std::string text;
+};
+
+struct StageResult {
+    std::string corpus;
+    std::size_t bytes = 0;
+    std::size_t tokens = 0;
+    std::size_t vocabulary = 0;
+    std::string stage;
+    std::size_t items = 0;          // tokens or distinct words, whichever the stage walks
+    std::size_t outputBytes = 0;    // coder stages: bytes written; 0 = not reported
+    double medianMs = 0;
+    double p95Ms = 0;
+    double baselineMs = -1;         // < 0: not in the baseline
+    bool regression = false;
+};
+
+// Discards everything: encode and friends then measure the coder, not the disk
+class NullBuffer : public std::streambuf {
+protected:
+    int_type overflow(int_type ch) override { return traits_type::not_eof(ch); }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+// One untimed warm-up run, then 'reps' timed runs, sorted, in milliseconds
+template <typename F>
+std::vector<double> sampleMs(int reps, F&& body) {
+    body();
+    std::vector<double> ms;
+    ms.reserve(reps);
+    for (int r = 0; r < reps; ++r) {
+        const auto start = Clock::now();
+        body();
+        const auto end = Clock::now();
+        ms.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    std::ranges::sort(ms);
+    return ms;
+}
+
+// Nearest-rank percentile of sorted samples
+double percentile(const std::vector<double>& sorted, double p) {
+    const auto rank = static_cast<std::size_t>(std::ceil(p * static_cast<double>(sorted.size())));
+    return sorted[std::clamp<std::size_t>(rank, 1, sorted.size()) - 1];
+}
+
+double median(const std::vector<double>& sorted) {
+    const std::size_t n = sorted.size();
+    return n % 2 == 1 ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2.0;
+}
+
+// The .txt files of 'dir' in name order, concatenated
+bool loadCorpusDir(const std::filesystem::path& dir, std::string& text) {
+    std::error_code ec;
+    std::vector<std::filesystem::path> files;
+    for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".txt") {
+            files.push_back(entry.path());
+        }
+    }
+    if (ec || files.empty()) {
+        return false;
+    }
+    std::ranges::sort(files);
+    for (const auto& path : files) {
+        MappedFile file;
+        if (file.open(path) != NO_ERROR) {
+            return false;
+        }
+        text.append(file.view());
+        text.push_back('\n');
+    }
+    return true;
+}
+
+// Time every stage on one corpus
+void runStages(const Corpus& corpus, int reps, std::vector<StageResult>& results) {
+    std::vector<std::string> tokens;
+    Scanner::tokenizeBuffer(corpus.text, tokens);
+    Counts counts;
+    {
+        BinSearchTree bst(TreeBalance::AVL);
+        bst.bulkInsert(tokens);
+        bst.inorderCollect(counts);
+    }
+
+    auto record = [&](const char* stage, std::size_t items, const std::vector<double>& ms,
+                      std::size_t outputBytes = 0) {
+        StageResult r;
+        r.corpus = corpus.name;
+        r.bytes = corpus.text.size();
+        r.tokens = tokens.size();
+        r.vocabulary = counts.size();
+        r.stage = stage;
+        r.items = items;
+        r.outputBytes = outputBytes;
+        r.medianMs = median(ms);
+        r.p95Ms = percentile(ms, 0.95);
+        results.push_back(std::move(r));
+        std::cerr << "  " << corpus.name << " / " << stage << ": " << results.back().medianMs << " ms\n";
+    };
+
+    record("tokenize", tokens.size(), sampleMs(reps, [&] {
+        std::vector<std::string> words;
+        Scanner::tokenizeBuffer(corpus.text, words);
+    }));
+
+    record("bst_bulk_insert", tokens.size(), sampleMs(reps, [&] {
+        BinSearchTree bst(TreeBalance::AVL);
+        bst.bulkInsert(tokens);
+    }));
+
+    // Leaves and parents live outside the timed region; each run resets the
+    // parents it overwrites, so only the queue itself is measured
+    std::vector<TreeNode> leaves;
+    leaves.reserve(counts.size());
+    for (std::size_t i = 0; i < counts.size(); ++i) {
+        leaves.emplace_back(counts[i].first);
+        leaves.back().freq = counts[i].second;
+        leaves.back().rank = static_cast<int>(i);
+    }
+    std::vector<TreeNode> parents(counts.empty() ? 0 : counts.size() - 1, TreeNode(""));
+    std::vector<TreeNode*> leafPointers;
+    leafPointers.reserve(leaves.size());
+    for (TreeNode& leaf : leaves) {
+        leafPointers.push_back(&leaf);
+    }
+    record("priority_queue", counts.size(), sampleMs(reps, [&] {
+        PriorityQueue pq(leafPointers);
+        std::size_t next = 0;
+        while (pq.size() > 1) {
+            TreeNode* a = pq.extractMin();
+            TreeNode* b = pq.extractMin();
+            TreeNode& parent = parents[next++];
+            parent.freq = a->freq + b->freq;
+            parent.rank = std::min(a->rank, b->rank);
+            parent.left = a;
+            parent.right = b;
+            pq.insert(&parent);
+        }
+    }));
+
+    record("build_from_counts", counts.size(), sampleMs(reps, [&] {
+        HuffmanTree tree = HuffmanTree::buildFromCounts(counts);
+    }));
+
+    const HuffmanTree tree = HuffmanTree::buildFromCounts(counts);
+    record("assign_codes", counts.size(), sampleMs(reps, [&] {
+        std::vector<std::pair<std::string, std::string>> codebook;
+        tree.assignCodes(codebook);
+    }));
+
+    record("write_header", counts.size(), sampleMs(reps, [&] {
+        std::ostringstream os;
+        (void)tree.writeHeader(os);
+    }));
+
+    record("encode", tokens.size(), sampleMs(reps, [&] {
+        NullBuffer sink;
+        std::ostream os(&sink);
+        (void)tree.encode(tokens, os, CodeFormat::BINARY);
+    }));
+
+    // Static vs adaptive: everything each needs to get from tokens to bytes
+    std::size_t staticBytes = 0;
+    const std::vector<double> staticMs = sampleMs(reps, [&] {
+        BinSearchTree bst(TreeBalance::AVL);
+        bst.bulkInsert(tokens);
+        Counts passCounts;
+        bst.inorderCollect(passCounts);
+        const HuffmanTree passTree = HuffmanTree::buildFromCounts(passCounts);
+        std::ostringstream os;
+        (void)passTree.writeHeader(os);
+        (void)passTree.encode(tokens, os, CodeFormat::BINARY);
+        staticBytes = os.str().size();
+    });
+    record("static_two_pass", tokens.size(), staticMs, staticBytes);
+
+    std::string adaptive;
+    const std::vector<double> adaptiveMs = sampleMs(reps, [&] {
+        std::ostringstream os;
+        AdaptiveHuffman model;
+        BitWriter writer(os);
+        for (const std::string& token : tokens) {
+            model.encode(token, writer);
+        }
+        model.finish(writer);
+        (void)writer.flush();
+        adaptive = os.str();
+    });
+    record("adaptive_encode", tokens.size(), adaptiveMs, adaptive.size());
+
+    record("adaptive_decode", tokens.size(), sampleMs(reps, [&] {
+        AdaptiveHuffman model;
+        BitReader reader(reinterpret_cast<const unsigned char*>(adaptive.data()), adaptive.size(),
+                         8 * static_cast<std::uint64_t>(adaptive.size()));
+        std::string_view word;
+        while (model.decode(reader, word) == NO_ERROR && !word.empty()) {
+        }
+    }), adaptive.size());
+}
+
+// Value of "key": in a one-line JSON object, without quotes; empty if absent
+std::string fieldOf(const std::string& line, std::string_view key) {
+    const std::string pattern = "\"" + std::string(key) + "\": ";
+    const std::size_t at = line.find(pattern);
+    if (at == std::string::npos) {
+        return {};
+    }
+    std::size_t begin = at + pattern.size();
+    if (begin < line.size() && line[begin] == '"') {
+        ++begin;
+        return line.substr(begin, line.find('"', begin) - begin);
+    }
+    const std::size_t end = line.find_first_of(",}", begin);
+    return line.substr(begin, end == std::string::npos ? std::string::npos : end - begin);
+}
+
+// Baseline medians keyed by "corpus/stage"
+bool readBaseline(const std::string& path, std::map<std::string, double>& medians) {
+    std::ifstream in(path);
+    if (!in) {
+        return false;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        const std::string stage = fieldOf(line, "stage");
+        const std::string ms = fieldOf(line, "median_ms");
+        if (!stage.empty() && !ms.empty()) {
+            medians[fieldOf(line, "corpus") + "/" + stage] = std::stod(ms);
+        }
+    }
+    return true;
+}
+
+void writeJson(std::ostream& os, const SuiteOptions& options, const std::vector<StageResult>& results) {
+    const double mb = 1024.0 * 1024.0;
+    char buf[512];
+    os << "{\n  \"suite\": \"huffman_bench\",\n  \"version\": 1,\n  \"reps\": " << options.reps
+       << ",\n  \"results\": [\n";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const StageResult& r = results[i];
+        const double seconds = r.medianMs / 1000.0;
+        std::snprintf(buf, sizeof buf,
+                      "    {\"corpus\": \"%s\", \"bytes\": %zu, \"tokens\": %zu, \"vocabulary\": %zu, "
+                      "\"stage\": \"%s\", \"items\": %zu, \"median_ms\": %.4f, \"p95_ms\": %.4f, "
+                      "\"mb_per_s\": %.2f, \"items_per_s\": %.0f",
+                      r.corpus.c_str(), r.bytes, r.tokens, r.vocabulary, r.stage.c_str(), r.items,
+                      r.medianMs, r.p95Ms, seconds > 0 ? static_cast<double>(r.bytes) / mb / seconds : 0.0,
+                      seconds > 0 ? static_cast<double>(r.items) / seconds : 0.0);
+        os << buf;
+        if (r.outputBytes > 0) {
+            std::snprintf(buf, sizeof buf, ", \"output_bytes\": %zu, \"bits_per_token\": %.3f", r.outputBytes,
+                          r.tokens > 0 ? 8.0 * static_cast<double>(r.outputBytes) / static_cast<double>(r.tokens) : 0.0);
+            os << buf;
+        }
+        if (r.baselineMs >= 0) {
+            std::snprintf(buf, sizeof buf, ", \"baseline_median_ms\": %.4f, \"change\": %+.4f, \"regression\": %s",
+                          r.baselineMs, r.medianMs / r.baselineMs - 1.0, r.regression ? "true" : "false");
+            os << buf;
+        }
+        os << (i + 1 < results.size() ? "},\n" : "}\n");
+    }
+    os << "  ]\n}\n";
+}
+
+bool parseArgs(int argc, char* argv[], SuiteOptions& options) {
+    // argv[1] is "suite"
+    for (int i = 2; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        const std::size_t eq = arg.find('=');
+        const std::string_view name = arg.substr(0, eq);
+        const std::string value = eq == std::string_view::npos ? "" : std::string(arg.substr(eq + 1));
+        try {
+            if (name == "--zipf" && value.find(':') != std::string::npos) {
+                const std::size_t colon = value.find(':');
+                options.zipf.push_back({std::stoul(value.substr(0, colon)), std::stoul(value.substr(colon + 1))});
+            } else if (name == "--exponent" && !value.empty()) {
+                options.exponent = std::stod(value);
+            } else if (name == "--reps" && !value.empty()) {
+                options.reps = std::max(1, std::stoi(value));
+            } else if (name == "--corpus") {
+                options.corpusDir = value; // --corpus= (empty) skips it
+            } else if (name == "--json" && !value.empty()) {
+                options.jsonPath = value;
+            } else if (name == "--baseline" && !value.empty()) {
+                options.baselinePath = value;
+            } else if (name == "--tolerance" && !value.empty()) {
+                options.tolerance = std::stod(value);
+            } else {
+                std::cerr << "suite: unknown option " << arg << "\n";
+                return false;
+            }
+        } catch (const std::exception&) {
+            std::cerr << "suite: bad value in " << arg << "\n";
+            return false;
+        }
+    }
+    if (options.zipf.empty()) {
+        options.zipf.push_back({8, 50000});
+    }
+    return true;
+}
+
+} // End of namespace
+
+std::string zipfCorpus(std::size_t bytes, std::size_t vocabulary, double exponent, std::uint64_t seed) {
+    vocabulary = std::max<std::size_t>(vocabulary, 1);
+
+    // Rank -> word. Ranks fill the 1-letter words first, then 2-letter, ...;
+    // within one length the rank is scrambled by an odd multiplier that is not
+    // a multiple of 13 (a bijection mod 26^length) so neighbours differ in spelling.
+    std::vector<std::string> words;
+    words.reserve(vocabulary);
+    for (int length = 1; words.size() < vocabulary; ++length) {
+        std::uint64_t span = 1;
+        for (int i = 0; i < length; ++i) {
+            span *= 26;
+        }
+        const std::uint64_t count = std::min<std::uint64_t>(span, vocabulary - words.size());
+        for (std::uint64_t j = 0; j < count; ++j) {
+            std::uint64_t value = (j * 1103515245ull) % span;
+            std::string word(length, 'a');
+            for (int i = length - 1; i >= 0; --i) {
+                word[i] = static_cast<char>('a' + value % 26);
+                value /= 26;
+            }
+            words.push_back(std::move(word));
+        }
+    }
+
+    // P(rank k) ~ 1 / (k + 1)^exponent, drawn by binary search on the running sum
+    std::vector<double> cumulative(vocabulary);
+    double total = 0;
+    for (std::size_t k = 0; k < vocabulary; ++k) {
+        total += 1.0 / std::pow(static_cast<double>(k + 1), exponent);
+        cumulative[k] = total;
+    }
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> pick(0.0, total);
+    std::uniform_int_distribution<int> sentenceLength(4, 16);
+    std::uniform_int_distribution<int> percent(0, 99);
+    auto drawWord = [&]() -> const std::string& {
+        const auto it = std::ranges::upper_bound(cumulative, pick(rng));
+        return words[std::min<std::size_t>(it - cumulative.begin(), vocabulary - 1)];
+    };
+
+    std::string text;
+    text.reserve(bytes + 128);
+    std::size_t lineStart = 0;
+    while (text.size() < bytes) {
+        const int length = sentenceLength(rng);
+        for (int w = 0; w < length; ++w) {
+            const std::string& word = drawWord();
+            if (text.size() > lineStart) {
+                if (text.size() - lineStart + word.size() >= 72) {
+                    text.push_back('\n');
+                    lineStart = text.size();
+                } else {
+                    text.push_back(' ');
+                }
+            }
+            text += word;
+            if (w == 0) {
+                text[text.size() - word.size()] = static_cast<char>(word[0] - 'a' + 'A');
+            }
+            if (w + 1 < length && percent(rng) < 8) {
+                text.push_back(',');
+            }
+        }
+        const int end = percent(rng);
+        text.push_back(end < 80 ? '.' : end < 90 ? '?' : '!');
+    }
+    text.push_back('\n');
+    return text;
+}
+
+int runSuite(int argc, char* argv[]) {
+    SuiteOptions options;
+    if (!parseArgs(argc, argv, options)) {
+        std::cerr << "Usage: " << argv[0] << " suite [--zipf=MB:VOCAB]... [--exponent=S] [--reps=N]"
+                  << " [--corpus=DIR] [--json=FILE] [--baseline=FILE] [--tolerance=F]\n";
+        return 1;
+    }
+
+    std::vector<Corpus> corpora;
+    if (!options.corpusDir.empty()) {
+        Corpus corpus{options.corpusDir.filename().string(), {}};
+        if (!loadCorpusDir(options.corpusDir, corpus.text)) {
+            std::cerr << "suite: no .txt files in " << options.corpusDir << "\n";
+            return 1;
+        }
+        corpora.push_back(std::move(corpus));
+    }
+    for (const ZipfSpec& spec : options.zipf) {
+        char name[96];
+        std::snprintf(name, sizeof name, "zipf-%zumb-%zu-s%.2f", spec.megabytes, spec.vocabulary, options.exponent);
+        // Fixed seed: the same flags always produce the same text
+        corpora.push_back({name, zipfCorpus(spec.megabytes << 20, spec.vocabulary, options.exponent, 0x5EED)});
+    }
+
+    std::vector<StageResult> results;
+    for (const Corpus& corpus : corpora) {
+        runStages(corpus, options.reps, results);
+    }
+
+    int regressions = 0;
+    if (!options.baselinePath.empty()) {
+        std::map<std::string, double> baseline;
+        if (!readBaseline(options.baselinePath, baseline)) {
+            std::cerr << "suite: cannot read baseline " << options.baselinePath << "\n";
+            return 1;
+        }
+        for (StageResult& r : results) {
+            const auto it = baseline.find(r.corpus + "/" + r.stage);
+            if (it == baseline.end() || it->second <= 0) {
+                continue;
+            }
+            r.baselineMs = it->second;
+            r.regression = r.medianMs > r.baselineMs * (1.0 + options.tolerance);
+            if (r.regression) {
+                ++regressions;
+                std::fprintf(stderr, "REGRESSION %s / %s: %.3f ms, baseline %.3f ms (%+.1f%%)\n",
+                             r.corpus.c_str(), r.stage.c_str(), r.medianMs, r.baselineMs,
+                             100.0 * (r.medianMs / r.baselineMs - 1.0));
+            }
+        }
+    }
+
+    if (options.jsonPath.empty()) {
+        writeJson(std::cout, options, results);
+    } else {
+        std::ofstream out(options.jsonPath);
+        writeJson(out, options, results);
+        if (!out) {
+            std::cerr << "suite: cannot write " << options.jsonPath << "\n";
+            return 1;
+        }
+    }
+    if (regressions > 0) {
+        std::cerr << regressions << " stage(s) slower than the baseline by more than "
+                  << options.tolerance * 100.0 << "%\n";
+        return 3;
+    }
+    return 0;
+}
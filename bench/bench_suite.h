@@ -0,0 +1,22 @@
+#ifndef BENCH_SUITE_H
+#define BENCH_SUITE_H
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Zipf-distributed text: 'vocabulary' distinct lowercase words, the k-th most
+// common drawn with probability proportional to 1 / k^exponent, written as
+// capitalized sentences with punctuation and line breaks, about 'bytes' long.
+// Common words are short, like in real text. Same arguments, same text.
+std::string zipfCorpus(std::size_t bytes, std::size_t vocabulary, double exponent, std::uint64_t seed);
+
+// huffman_bench suite [options]: time every pipeline stage on its own, on the
+// input_output corpus and on generated Zipf corpora, and print JSON with the
+// median, p95 and throughput of each. With --baseline=FILE, compare medians
+// against an earlier run and flag regressions. Returns 0, 1 on bad
+// arguments, or 3 if a regression was flagged.
+int runSuite(int argc, char* argv[]);
+
+#endif //BENCH_SUITE_H
@@ -0,0 +1,1014 @@
+//
+// Benchmarks for the Huffman pipeline. Not part of the graded program:
+// built only by CMake (target huffman_bench).
+//
+// Usage: huffman_bench build [max_vocabulary]
+//        huffman_bench scan  [corpus_dir]      (default: input_output)
+//        huffman_bench verify-scan [random_cases]
+//        huffman_bench scan-threads [size_mb] [max_threads]
+//        huffman_bench count [size_mb] [vocabulary]
+//        huffman_bench tree [size_mb]
+//        huffman_bench pipeline [size_mb]    (POSIX: peak memory via fork/wait4)
+//        huffman_bench alloc [vocabulary]
+//        huffman_bench layout [size_mb] [vocabulary]
+//        huffman_bench encode [size_mb]
+//        huffman_bench encode-threads [size_mb] [max_threads]
+//        huffman_bench blocks [size_mb] [threads]
+//        huffman_bench batch [size_mb] [max_threads]
+//        huffman_bench suite [--zipf=MB:VOCAB]... [--json=FILE] [--baseline=FILE] ...
+//                      (per-stage JSON timings, see bench_suite.cpp)
+//
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#define HUFFMAN_BENCH_HAS_FORK 1
+#endif
+#include "bench_suite.h"
+#include "BinSearchTree.h"
+#include "BlockCode.h"
+#include "FrequencyCounter.h"
+#include "FlatHuffmanTree.h"
+#include "HuffmanTree.h"
+#include "Pipeline.h"
+#include "MappedFile.h"
+#include "NodeArena.h"
+#include "Scanner.hpp"
+#include "StringInterner.h"
+#include "ThreadPool.h"
+#include "TreeNode.h"
+
+// Instrumentation hook: every global operator new in this process is counted.
+// They stay out of line: once inlined, GCC pairs malloc()/free() with the
+// new/delete at the call site and reports a mismatch (-Wmismatched-new-delete)
+namespace {
+std::atomic<std::uint64_t> heapAllocations{0};
+}
+
+[[gnu::noinline]] void* operator new(std::size_t bytes) {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(bytes == 0 ? 1 : bytes)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+[[gnu::noinline]] void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void* operator new[](std::size_t bytes) {
+    return ::operator new(bytes);
+}
+
+void operator delete[](void* p) noexcept {
+    ::operator delete(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    ::operator delete(p);
+}
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using Counts = std::vector<std::pair<std::string, int>>;
+
+// Best of 'reps' runs, in milliseconds
+template <typename F>
+double timeMs(int reps, F&& body) {
+    double best = 1e300;
+    for (int r = 0; r < reps; ++r) {
+        const auto start = Clock::now();
+        body();
+        const auto end = Clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    return best;
+}
+
+// Synthetic vocabulary: lexicographically sorted words with Zipf-like counts
+// (count of the i-th most common word ~ N / i), shuffled over the word list so
+// frequency and spelling are unrelated. Many words end up with equal counts,
+// which exercises the tie-breaking.
+Counts syntheticCounts(std::size_t vocabulary) {
+    Counts counts(vocabulary);
+    char buf[24];
+    for (std::size_t i = 0; i < vocabulary; ++i) {
+        std::snprintf(buf, sizeof buf, "w%08zu", i);
+        counts[i].first = buf;
+    }
+    std::uint64_t state = 0x9E3779B97F4A7C15ull; // fixed seed, repeatable runs
+    for (std::size_t i = 0; i < vocabulary; ++i) {
+        state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+        const std::size_t slot = state % vocabulary;
+        counts[i].second = static_cast<int>(vocabulary / (slot + 1)) + 1;
+    }
+    return counts;
+}
+
+// Old construction, kept here as the reference: insert appends and re-sorts
+// the whole vector, and parents copy the smaller word for tie-breaking.
+std::size_t legacyBuild(const Counts& counts) {
+    auto higher = [](const TreeNode* a, const TreeNode* b) {
+        if (a->freq != b->freq) return a->freq > b->freq;
+        return a->key_word < b->key_word;
+    };
+    std::vector<TreeNode*> items, all;
+    for (const auto& [word, freq] : counts) {
+        auto* node = new TreeNode(word);
+        node->freq = freq;
+        items.push_back(node);
+        all.push_back(node);
+    }
+    std::ranges::sort(items, higher);
+    while (items.size() > 1) {
+        TreeNode* a = items.back(); items.pop_back();
+        TreeNode* b = items.back(); items.pop_back();
+        auto* parent = new TreeNode(std::min(a->key_word, b->key_word));
+        parent->freq = a->freq + b->freq;
+        parent->left = a;
+        parent->right = b;
+        all.push_back(parent);
+        items.push_back(parent);
+        std::ranges::sort(items, higher);
+    }
+    for (TreeNode* n : all) delete n;
+    return all.size();
+}
+
+int benchBuild(std::size_t maxVocabulary) {
+    constexpr std::size_t LEGACY_LIMIT = 4000; // ~30 s at 16000: quadratic
+    std::cout << std::left << std::setw(12) << "vocabulary"
+              << std::right << std::setw(14) << "legacy ms"
+              << std::setw(14) << "heap ms"
+              << std::setw(14) << "two-queue ms"
+              << std::setw(12) << "same codes" << "\n";
+
+    for (std::size_t n = 1000; n <= maxVocabulary; n *= 4) {
+        const Counts counts = syntheticCounts(n);
+
+        // Times cover construction and teardown of the tree
+        const double heapMs = timeMs(3, [&] { HuffmanTree::buildFromCounts(counts, {.strategy = MergeStrategy::HEAP}); });
+        const double queueMs = timeMs(3, [&] { HuffmanTree::buildFromCounts(counts, {.strategy = MergeStrategy::TWO_QUEUE}); });
+
+        std::vector<std::pair<std::string, std::string>> heapCodes, queueCodes;
+        HuffmanTree::buildFromCounts(counts, {.strategy = MergeStrategy::HEAP}).assignCodes(heapCodes);
+        HuffmanTree::buildFromCounts(counts, {.strategy = MergeStrategy::TWO_QUEUE}).assignCodes(queueCodes);
+
+        std::cout << std::left << std::setw(12) << n << std::right << std::fixed << std::setprecision(2);
+        if (n <= LEGACY_LIMIT) {
+            std::cout << std::setw(14) << timeMs(1, [&] { legacyBuild(counts); });
+        } else {
+            std::cout << std::setw(14) << "-";
+        }
+        std::cout << std::setw(14) << heapMs << std::setw(14) << queueMs
+                  << std::setw(12) << (heapCodes == queueCodes ? "yes" : "NO") << "\n";
+        if (heapCodes != queueCodes) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// The .txt files of a corpus directory, sorted by name
+std::vector<std::filesystem::path> corpusFiles(const std::filesystem::path& dir) {
+    std::vector<std::filesystem::path> files;
+    for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".txt") {
+            files.push_back(entry.path());
+        }
+    }
+    std::ranges::sort(files);
+    return files;
+}
+
+// Kernels to compare: the scalar reference plus each SIMD kernel this CPU runs
+std::vector<ScanKernel> availableKernels() {
+    std::vector<ScanKernel> kernels{ScanKernel::SCALAR};
+    for (ScanKernel k : {ScanKernel::SSE2, ScanKernel::AVX2}) {
+        if (resolveScanKernel(k) == k) kernels.push_back(k);
+    }
+    return kernels;
+}
+
+// Per-file tokenize time: original stream reader vs. each buffer kernel
+int benchScan(const std::filesystem::path& corpus) {
+    const double mb = 1024.0 * 1024.0;
+    const std::vector<ScanKernel> kernels = availableKernels();
+    std::vector<double> kernelTotals(kernels.size(), 0.0);
+    double streamTotal = 0, bytesTotal = 0;
+
+    std::cout << std::left << std::setw(36) << "file" << std::right << std::setw(10) << "KB" << std::setw(12) << "stream ms";
+    for (ScanKernel k : kernels) {
+        std::cout << std::setw(12) << (std::string(scanKernelName(k)) + " ms");
+    }
+    std::cout << "\n";
+
+    for (const auto& path : corpusFiles(corpus)) {
+        Scanner scanner(path);
+        std::vector<std::string> streamWords;
+        const double streamMs = timeMs(5, [&] { scanner.tokenizeStream(streamWords); });
+        const double bytes = static_cast<double>(std::filesystem::file_size(path));
+        streamTotal += streamMs;
+        bytesTotal += bytes;
+        std::cout << std::left << std::setw(36) << path.filename().string() << std::right << std::fixed
+                  << std::setprecision(1) << std::setw(10) << bytes / 1024.0 << std::setprecision(3)
+                  << std::setw(12) << streamMs;
+
+        MappedFile file;
+        file.open(path);
+        for (std::size_t k = 0; k < kernels.size(); ++k) {
+            std::vector<std::string> words;
+            const double ms = timeMs(5, [&] {
+                words.clear();
+                Scanner::tokenizeBuffer(file.view(), words, kernels[k]);
+            });
+            if (words != streamWords) {
+                std::cerr << "\nToken mismatch in " << path << " (" << scanKernelName(kernels[k]) << ")\n";
+                return 1;
+            }
+            kernelTotals[k] += ms;
+            std::cout << std::setw(12) << ms;
+        }
+        std::cout << "\n";
+    }
+
+    std::cout << std::fixed << std::setprecision(1) << "total MB/s: stream " << bytesTotal / mb / (streamTotal / 1000.0);
+    for (std::size_t k = 0; k < kernels.size(); ++k) {
+        std::cout << ", " << scanKernelName(kernels[k]) << " " << bytesTotal / mb / (kernelTotals[k] / 1000.0);
+    }
+    std::cout << "\n";
+    return 0;
+}
+
+// Differential check: every SIMD kernel must match the scalar path byte for
+// byte, on random text and on inputs built to hit the block edges.
+int verifyScan(std::size_t randomCases) {
+    std::vector<std::string> inputs;
+
+    // Adversarial: apostrophes and word edges on and around the 64-byte block
+    // boundaries, bytes just outside the letter ranges, and high bytes whose
+    // low bits look like letters.
+    const std::string edgeBytes = "aZ'`{@[\x7f\x80\xc1\xe1\xfa\xda 09-";
+    for (std::size_t len = 0; len <= 200; ++len) {
+        for (std::size_t at : {std::size_t{0}, std::size_t{62}, std::size_t{63}, std::size_t{64},
+                               std::size_t{65}, std::size_t{127}, std::size_t{128}}) {
+            if (at + 3 > len) continue;
+            for (const char* pattern : {"a'b", "''a", "a''", "b'", "'x", "x'y'z"}) {
+                std::string s(len, 'q');
+                for (std::size_t k = 0; pattern[k] != '\0' && at + k < len; ++k) s[at + k] = pattern[k];
+                inputs.push_back(s);
+                std::ranges::replace(s, 'q', ' ');
+                for (std::size_t k = 0; pattern[k] != '\0' && at + k < len; ++k) s[at + k] = pattern[k];
+                inputs.push_back(s);
+            }
+        }
+    }
+    inputs.emplace_back(1000, '\'');
+    inputs.push_back(std::string(129, 'a') + "'");
+    inputs.push_back(edgeBytes);
+
+    // Random: bytes drawn mostly from the interesting classes
+    std::uint64_t state = 0x2545F4914F6CDD1Dull;
+    auto next = [&state] { state ^= state << 13; state ^= state >> 7; state ^= state << 17; return state; };
+    for (std::size_t c = 0; c < randomCases; ++c) {
+        std::string s(next() % 700, '\0');
+        for (char& ch : s) {
+            const std::uint64_t r = next();
+            switch (r % 4) {
+                case 0: ch = static_cast<char>('a' + (r >> 8) % 26); break;
+                case 1: ch = static_cast<char>('A' + (r >> 8) % 26); break;
+                case 2: ch = edgeBytes[(r >> 8) % edgeBytes.size()]; break;
+                default: ch = static_cast<char>(r >> 8); break;
+            }
+        }
+        inputs.push_back(std::move(s));
+    }
+
+    const std::vector<ScanKernel> kernels = availableKernels();
+    for (const std::string& input : inputs) {
+        std::vector<std::string> expected;
+        Scanner::tokenizeBuffer(input, expected, ScanKernel::SCALAR);
+        for (ScanKernel k : kernels) {
+            std::vector<std::string> actual;
+            Scanner::tokenizeBuffer(input, actual, k);
+            if (actual != expected) {
+                std::cerr << "Kernel " << scanKernelName(k) << " differs from scalar on input of "
+                          << input.size() << " bytes\n";
+                return 1;
+            }
+        }
+    }
+    std::cout << "verify-scan: " << inputs.size() << " inputs, kernels:";
+    for (ScanKernel k : kernels) std::cout << ' ' << scanKernelName(k);
+    std::cout << " - all match\n";
+    return 0;
+}
+
+// The corpus .txt files concatenated and repeated up to 'bytes'
+std::string repeatedCorpus(const std::filesystem::path& corpus, std::size_t bytes) {
+    std::string one;
+    for (const auto& path : corpusFiles(corpus)) {
+        std::ifstream in(path, std::ios::binary);
+        one.append(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    std::string text;
+    text.reserve(bytes + one.size());
+    while (!one.empty() && text.size() < bytes) {
+        text += one;
+    }
+    return text;
+}
+
+// Parallel tokenize scaling: 1, 2, 4, ... threads up to max_threads
+int benchScanThreads(std::size_t megabytes, unsigned maxThreads) {
+    const std::string text = repeatedCorpus("input_output", megabytes << 20);
+    const double mb = static_cast<double>(text.size()) / (1024.0 * 1024.0);
+
+    // Every run fills a fresh vector, as tokenize() does
+    std::vector<std::string> serial;
+    const double serialMs = timeMs(3, [&] { serial = {}; Scanner::tokenizeBuffer(text, serial); });
+    std::cout << std::fixed << std::setprecision(1) << "input " << mb << " MB, " << serial.size()
+              << " tokens, serial " << serialMs << " ms\n";
+    std::cout << std::setw(8) << "threads" << std::setw(12) << "ms" << std::setw(12) << "MB/s"
+              << std::setw(10) << "speedup" << "\n";
+
+    for (unsigned t = 1; t <= maxThreads; t = (t == maxThreads || 2 * t <= maxThreads) ? 2 * t : maxThreads) {
+        ThreadPool pool(t);
+        std::vector<std::string> words;
+        const double ms = timeMs(3, [&] { words = {}; Scanner::tokenizeBufferParallel(text, words, pool); });
+        if (words != serial) {
+            std::cerr << "Parallel tokens differ from serial with " << t << " threads\n";
+            return 1;
+        }
+        std::cout << std::setw(8) << t << std::setw(12) << ms << std::setw(12) << mb / (ms / 1000.0)
+                  << std::setprecision(2) << std::setw(9) << serialMs / ms << "x\n" << std::setprecision(1);
+    }
+    return 0;
+}
+
+// Time one counter kind over 'tokens' (BST gets the shuffled order main uses)
+double timeCounter(CounterKind kind, const std::vector<std::string>& tokens, Counts& out) {
+    return timeMs(3, [&] {
+        auto counter = FrequencyCounter::create(kind);
+        counter->bulkAdd(tokens);
+        out.clear();
+        counter->collect(out);
+    });
+}
+
+// Counting engines: BST vs. hash on the corpus and on a large synthetic vocabulary
+int benchCount(std::size_t megabytes, std::size_t vocabulary) {
+    // Corpus repeated to 'megabytes': few distinct words, many repeats
+    std::vector<std::string> corpusTokens;
+    Scanner::tokenizeBuffer(repeatedCorpus("input_output", megabytes << 20), corpusTokens);
+
+    // Synthetic: 'vocabulary' distinct words drawn with Zipf-like skew
+    std::vector<std::string> syntheticTokens;
+    for (const auto& [word, count] : syntheticCounts(vocabulary)) {
+        syntheticTokens.insert(syntheticTokens.end(), static_cast<std::size_t>(count), word);
+    }
+
+    const std::pair<const char*, std::vector<std::string>*> inputs[] = {
+        {"corpus", &corpusTokens}, {"synthetic", &syntheticTokens}};
+    std::cout << std::setw(10) << "input" << std::setw(12) << "tokens" << std::setw(10) << "distinct"
+              << std::setw(12) << "bst ms" << std::setw(12) << "hash ms" << std::setw(10) << "speedup" << "\n";
+    for (const auto& [name, tokens] : inputs) {
+        std::mt19937 rng(0xC0FFEE);
+        std::shuffle(tokens->begin(), tokens->end(), rng);
+
+        Counts bstCounts, hashCounts;
+        const double bstMs = timeCounter(CounterKind::BST, *tokens, bstCounts);
+        const double hashMs = timeCounter(CounterKind::HASH, *tokens, hashCounts);
+        if (bstCounts != hashCounts) {
+            std::cerr << "Hash counts differ from BST counts on " << name << "\n";
+            return 1;
+        }
+        std::cout << std::fixed << std::setprecision(1) << std::setw(10) << name << std::setw(12) << tokens->size()
+                  << std::setw(10) << bstCounts.size() << std::setw(12) << bstMs << std::setw(12) << hashMs
+                  << std::setprecision(2) << std::setw(9) << bstMs / hashMs << "x\n";
+    }
+    return 0;
+}
+
+// Plain vs. AVL BinSearchTree on shuffled and on sorted tokens. Sorted input
+// is the plain tree's worst case (a linked list), so keep size_mb small.
+int benchTree(std::size_t megabytes) {
+    std::vector<std::string> shuffled;
+    Scanner::tokenizeBuffer(repeatedCorpus("input_output", megabytes << 20), shuffled);
+    std::mt19937 rng(0xC0FFEE);
+    std::shuffle(shuffled.begin(), shuffled.end(), rng);
+    std::vector<std::string> sorted = shuffled;
+    std::sort(sorted.begin(), sorted.end());
+
+    const std::pair<const char*, const std::vector<std::string>*> orders[] = {
+        {"shuffled", &shuffled}, {"sorted", &sorted}};
+    std::cout << shuffled.size() << " tokens\n";
+    std::cout << std::setw(10) << "order" << std::setw(8) << "tree" << std::setw(10) << "height"
+              << std::setw(12) << "ms" << "\n";
+    for (const auto& [name, tokens] : orders) {
+        for (TreeBalance balance : {TreeBalance::NONE, TreeBalance::AVL}) {
+            unsigned height = 0;
+            const double ms = timeMs(1, [&] {
+                BinSearchTree tree(balance);
+                tree.bulkInsert(*tokens);
+                height = tree.height();
+            });
+            std::cout << std::fixed << std::setprecision(1) << std::setw(10) << name
+                      << std::setw(8) << (balance == TreeBalance::AVL ? "avl" : "plain")
+                      << std::setw(10) << height << std::setw(12) << ms << "\n";
+        }
+    }
+    return 0;
+}
+
+#ifdef HUFFMAN_BENCH_HAS_FORK
+// Run one full compressFile() in a child process, so its peak RSS is its own
+bool runPipelineChild(const std::filesystem::path& input, const std::filesystem::path& outDir,
+                      const PipelineOptions& options, double& ms, long& peakKb) {
+    const auto start = Clock::now();
+    const pid_t pid = fork();
+    if (pid == 0) {
+        std::ofstream quiet; // report goes nowhere
+        _exit(compressFile(input, outDir, options, quiet));
+    }
+    int status = 0;
+    rusage usage{};
+    if (pid < 0 || wait4(pid, &status, 0, &usage) != pid) {
+        return false;
+    }
+    ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+#ifdef __APPLE__
+    peakKb = usage.ru_maxrss / 1024; // bytes on macOS
+#else
+    peakKb = usage.ru_maxrss;        // kilobytes on Linux
+#endif
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+// Whole pipeline, string tokens vs. interned IDs vs. streaming: wall time and peak memory
+int benchPipeline(std::size_t megabytes) {
+    namespace fs = std::filesystem;
+    const fs::path work = fs::temp_directory_path() / "huffman_bench_pipeline";
+    fs::create_directories(work);
+    const fs::path input = work / "corpus.txt";
+    {
+        const std::string text = repeatedCorpus("input_output", megabytes << 20);
+        std::ofstream(input, std::ios::binary).write(text.data(), static_cast<std::streamsize>(text.size()));
+    }
+
+    const std::pair<const char*, PipelineOptions> runs[] = {
+        {"strings", {.kind = PipelineKind::STRINGS}},
+        {"interned", {.kind = PipelineKind::INTERNED}},
+        {"streaming", {.kind = PipelineKind::STREAMING}},
+        {"stream-nt", {.kind = PipelineKind::STREAMING, .writeTokens = false}}};
+    std::cout << std::setw(10) << "pipeline" << std::setw(12) << "wall ms" << std::setw(14) << "peak RSS MB" << "\n";
+    for (const auto& [name, options] : runs) {
+        fs::create_directories(work / name);
+        double best = 1e300;
+        long peakKb = 0;
+        for (int r = 0; r < 3; ++r) {
+            double ms = 0;
+            long kb = 0;
+            if (!runPipelineChild(input, work / name, options, ms, kb)) {
+                std::cerr << name << " pipeline failed\n";
+                return 1;
+            }
+            best = std::min(best, ms);
+            peakKb = std::max(peakKb, kb);
+        }
+        std::cout << std::fixed << std::setprecision(1) << std::setw(10) << name << std::setw(12) << best
+                  << std::setw(14) << static_cast<double>(peakKb) / 1024.0 << "\n";
+    }
+
+    // All must have written the same files (stream-nt has no .tokens)
+    for (const auto& [name, options] : runs) {
+        for (const char* ext : {".tokens", ".freq", ".hdr", ".code"}) {
+            if (!options.writeTokens && std::string_view(ext) == ".tokens") {
+                continue;
+            }
+            std::ifstream a(work / "strings" / (std::string("corpus") + ext), std::ios::binary);
+            std::ifstream b(work / name / (std::string("corpus") + ext), std::ios::binary);
+            if (!std::equal(std::istreambuf_iterator<char>(a), std::istreambuf_iterator<char>(),
+                            std::istreambuf_iterator<char>(b), std::istreambuf_iterator<char>())) {
+                std::cerr << name << " pipeline wrote a different corpus" << ext << "\n";
+                return 1;
+            }
+        }
+    }
+    fs::remove_all(work);
+    return 0;
+}
+#endif
+
+// Heap allocations and build/teardown time of both trees on arena nodes,
+// next to what one new/delete per node costs for the same node count
+int benchAlloc(std::size_t vocabulary) {
+    const Counts counts = syntheticCounts(vocabulary);
+    std::vector<std::string> words;
+    for (const auto& [word, count] : counts) words.push_back(word);
+    std::mt19937 rng(0xC0FFEE);
+    std::shuffle(words.begin(), words.end(), rng);
+
+    std::cout << std::setw(8) << "tree" << std::setw(10) << "nodes" << std::setw(12) << "heap allocs"
+              << std::setw(10) << "blocks" << std::setw(12) << "build ms" << std::setw(14) << "teardown ms"
+              << std::setw(16) << "new/delete ms" << "\n";
+    auto row = [&](const char* name, std::size_t nodes, std::uint64_t allocs, std::uint64_t blocks,
+                   double buildMs, double teardownMs) {
+        // Reference: the same number of nodes, each allocated and freed on its own
+        std::vector<TreeNode*> loose(nodes);
+        const double perNodeMs = timeMs(1, [&] {
+            for (std::size_t i = 0; i < nodes; ++i) loose[i] = new TreeNode(words[i % words.size()]);
+            for (TreeNode* n : loose) delete n;
+        });
+        std::cout << std::fixed << std::setprecision(2) << std::setw(8) << name << std::setw(10) << nodes
+                  << std::setw(12) << allocs << std::setw(10) << blocks << std::setw(12) << buildMs
+                  << std::setw(14) << teardownMs << std::setw(16) << perNodeMs << "\n";
+    };
+
+    {
+        const std::uint64_t allocs0 = heapAllocations.load();
+        const std::uint64_t blocks0 = NodeArena::totalBlockAllocations();
+        auto start = Clock::now();
+        auto tree = std::make_unique<BinSearchTree>(TreeBalance::AVL);
+        tree->bulkInsert(words);
+        const double buildMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        const std::uint64_t allocs = heapAllocations.load() - allocs0 - 1; // minus the tree object
+        const std::uint64_t blocks = NodeArena::totalBlockAllocations() - blocks0;
+        const std::size_t nodes = tree->size();
+        start = Clock::now();
+        tree.reset();
+        row("bst", nodes, allocs, blocks, buildMs,
+            std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+    }
+    {
+        const std::uint64_t allocs0 = heapAllocations.load();
+        const std::uint64_t blocks0 = NodeArena::totalBlockAllocations();
+        auto start = Clock::now();
+        auto tree = std::make_unique<HuffmanTree>(HuffmanTree::buildFromCounts(counts));
+        const double buildMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        const std::uint64_t allocs = heapAllocations.load() - allocs0 - 1;
+        const std::uint64_t blocks = NodeArena::totalBlockAllocations() - blocks0;
+        start = Clock::now();
+        tree.reset();
+        row("huffman", 2 * counts.size() - 1, allocs, blocks, buildMs,
+            std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+    }
+    return 0;
+}
+
+// Symbol-numbered input for the tree stages: words in lexicographic order,
+// their counts, and the token stream as symbols
+struct SymbolInput {
+    std::vector<std::string> storage;
+    std::vector<std::string_view> words;
+    std::vector<int> freqs;
+    std::vector<std::uint32_t> symbols;
+};
+
+SymbolInput corpusSymbols(std::size_t megabytes) {
+    StringInterner interner;
+    SymbolInput in;
+    Scanner::tokenizeBuffer(repeatedCorpus("input_output", megabytes << 20), in.symbols, interner);
+    std::vector<std::uint32_t> order(interner.size());
+    for (std::size_t i = 0; i < order.size(); ++i) order[i] = static_cast<std::uint32_t>(i);
+    std::ranges::sort(order, [&](std::uint32_t a, std::uint32_t b) { return interner.word(a) < interner.word(b); });
+    std::vector<std::uint32_t> symbolOf(order.size());
+    for (std::size_t s = 0; s < order.size(); ++s) {
+        symbolOf[order[s]] = static_cast<std::uint32_t>(s);
+        in.storage.emplace_back(interner.word(order[s]));
+    }
+    in.freqs.assign(order.size(), 0);
+    for (std::uint32_t& id : in.symbols) {
+        id = symbolOf[id];
+        in.freqs[id]++;
+    }
+    for (const std::string& w : in.storage) in.words.push_back(w);
+    return in;
+}
+
+SymbolInput syntheticSymbols(std::size_t vocabulary) {
+    SymbolInput in;
+    for (auto& [word, count] : syntheticCounts(vocabulary)) { // already in lexicographic order
+        const auto symbol = static_cast<std::uint32_t>(in.storage.size());
+        in.storage.push_back(std::move(word));
+        in.freqs.push_back(count);
+        in.symbols.insert(in.symbols.end(), static_cast<std::size_t>(count), symbol);
+    }
+    std::mt19937 rng(0xC0FFEE);
+    std::shuffle(in.symbols.begin(), in.symbols.end(), rng);
+    for (const std::string& w : in.storage) in.words.push_back(w);
+    return in;
+}
+
+// Time the tree stages on one layout; 'codes' receives the code table
+template <typename Tree>
+void timeLayout(const char* input, const char* layout, const SymbolInput& in, bool canonical,
+                std::vector<std::string>& codes) {
+    double buildMs = timeMs(3, [&] {
+        Tree tree = Tree::buildFromSymbolCounts(in.freqs, in.words);
+        if (canonical) tree.makeCanonical();
+    });
+    Tree tree = Tree::buildFromSymbolCounts(in.freqs, in.words);
+    if (canonical) tree.makeCanonical();
+
+    std::vector<std::pair<std::string, std::string>> codebook;
+    const double assignMs = timeMs(3, [&] { tree.assignCodes(codebook); });
+    const double headerMs = timeMs(3, [&] { std::ostringstream os; tree.writeHeader(os); });
+    const double encodeMs = timeMs(3, [&] { std::ostringstream os; tree.encode(in.symbols, os, CodeFormat::BINARY); });
+    tree.codeTable(codes);
+    std::cout << std::fixed << std::setprecision(2) << std::setw(10) << input << std::setw(9) << layout
+              << std::setw(11) << (canonical ? "canonical" : "huffman") << std::setw(11) << buildMs
+              << std::setw(11) << assignMs << std::setw(11) << headerMs << std::setw(11) << encodeMs << "\n";
+}
+
+// Pointer tree vs. flat arrays: build, code assignment, header and encode
+int benchLayout(std::size_t megabytes, std::size_t vocabulary) {
+    const std::pair<const char*, SymbolInput> inputs[] = {
+        {"corpus", corpusSymbols(megabytes)}, {"synthetic", syntheticSymbols(vocabulary)}};
+    std::cout << std::setw(10) << "input" << std::setw(9) << "layout" << std::setw(11) << "codes"
+              << std::setw(11) << "build ms" << std::setw(11) << "assign ms" << std::setw(11) << "header ms"
+              << std::setw(11) << "encode ms" << "\n";
+    for (const auto& [name, in] : inputs) {
+        std::cout << "# " << name << ": " << in.words.size() << " symbols, " << in.symbols.size() << " tokens\n";
+        for (bool canonical : {false, true}) {
+            std::vector<std::string> pointerCodes, flatCodes;
+            timeLayout<HuffmanTree>(name, "pointer", in, canonical, pointerCodes);
+            timeLayout<FlatHuffmanTree>(name, "flat", in, canonical, flatCodes);
+            if (pointerCodes != flatCodes) {
+                std::cerr << "Flat layout codes differ on " << name << "\n";
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+// Discards everything written to it, so timings leave out the destination
+class NullBuffer : public std::streambuf {
+protected:
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+    int overflow(int c) override { return traits_type::not_eof(c); }
+};
+
+// Encode throughput: the old word->string map building one big '0'/'1'
+// string, a string code table through the bit writer, and the integer table
+int benchEncode(std::size_t megabytes) {
+    const SymbolInput in = corpusSymbols(megabytes);
+    const HuffmanTree tree = HuffmanTree::buildFromSymbolCounts(in.freqs, in.words);
+    const double inputMb = static_cast<double>(megabytes);
+
+    std::vector<std::pair<std::string, std::string>> codebook;
+    tree.assignCodes(codebook);
+    std::vector<std::string> stringCodes;
+    tree.codeTable(stringCodes);
+
+    auto legacy = [&](std::ostream& os) {
+        std::unordered_map<std::string, std::string> codes;
+        for (auto& [word, code] : codebook) codes[word] = code;
+        std::string encoded;
+        for (std::uint32_t s : in.symbols) encoded += codes[in.storage[s]];
+        BitWriter writer(os);
+        for (char c : encoded) writer.putBit(c == '1');
+        writer.finish();
+    };
+    auto stringTable = [&](std::ostream& os) {
+        BitWriter writer(os);
+        for (std::uint32_t s : in.symbols) writer.putBits(stringCodes[s]);
+        writer.finish();
+    };
+    auto integerTable = [&](std::ostream& os) { tree.encode(in.symbols, os, CodeFormat::BINARY); };
+    auto integerAscii = [&](std::ostream& os) { tree.encode(in.symbols, os, CodeFormat::ASCII); };
+
+    std::ostringstream reference;
+    integerTable(reference);
+    std::cout << "# " << in.symbols.size() << " tokens, " << reference.str().size() << " bytes of .code\n";
+    std::cout << std::setw(16) << "encoder" << std::setw(12) << "ms" << std::setw(12) << "input MB/s" << "\n";
+    const std::pair<const char*, std::function<void(std::ostream&)>> encoders[] = {
+        {"map+string", legacy}, {"string table", stringTable},
+        {"bitcode", integerTable}, {"bitcode ascii", integerAscii}};
+    for (const auto& [name, encode] : encoders) {
+        if (name != std::string_view("bitcode ascii")) {
+            std::ostringstream os;
+            encode(os);
+            if (os.str() != reference.str()) {
+                std::cerr << name << " wrote a different .code\n";
+                return 1;
+            }
+        }
+        NullBuffer sink;
+        std::ostream os(&sink);
+        const double ms = timeMs(3, [&] { encode(os); });
+        std::cout << std::fixed << std::setprecision(1) << std::setw(16) << name << std::setw(12) << ms
+                  << std::setw(12) << inputMb / (ms / 1000.0) << "\n";
+    }
+    return 0;
+}
+
+// Parallel encode scaling: 1, 2, 4, ... threads up to max_threads, both formats
+int benchEncodeThreads(std::size_t megabytes, unsigned maxThreads) {
+    const SymbolInput in = corpusSymbols(megabytes);
+    const HuffmanTree tree = HuffmanTree::buildFromSymbolCounts(in.freqs, in.words);
+    const double inputMb = static_cast<double>(megabytes);
+    std::cout << "# " << in.symbols.size() << " tokens\n";
+    std::cout << std::setw(8) << "format" << std::setw(8) << "threads" << std::setw(12) << "ms"
+              << std::setw(12) << "input MB/s" << std::setw(10) << "speedup" << "\n";
+
+    for (CodeFormat format : {CodeFormat::BINARY, CodeFormat::ASCII}) {
+        const char* name = format == CodeFormat::BINARY ? "binary" : "ascii";
+        std::ostringstream serial;
+        tree.encode(in.symbols, serial, format);
+        NullBuffer sink;
+        std::ostream discard(&sink);
+        const double serialMs = timeMs(3, [&] { tree.encode(in.symbols, discard, format); });
+
+        for (unsigned t = 1; t <= maxThreads; t = (t == maxThreads || 2 * t <= maxThreads) ? 2 * t : maxThreads) {
+            ThreadPool pool(t);
+            std::ostringstream parallel;
+            tree.encode(in.symbols, parallel, format, pool);
+            if (parallel.str() != serial.str()) {
+                std::cerr << "Parallel " << name << " encode differs from serial with " << t << " threads\n";
+                return 1;
+            }
+            const double ms = timeMs(3, [&] { tree.encode(in.symbols, discard, format, pool); });
+            std::cout << std::fixed << std::setprecision(1) << std::setw(8) << name << std::setw(8) << t
+                      << std::setw(12) << ms << std::setw(12) << inputMb / (ms / 1000.0)
+                      << std::setprecision(2) << std::setw(9) << serialMs / ms << "x\n";
+        }
+    }
+    return 0;
+}
+
+// Blocked container: size overhead vs. plain binary, serial and parallel
+// decode, and the cost of seeking to one token, for several block sizes
+int benchBlocks(std::size_t megabytes, unsigned threads) {
+    const SymbolInput in = corpusSymbols(megabytes);
+    const HuffmanTree tree = HuffmanTree::buildFromSymbolCounts(in.freqs, in.words);
+    std::vector<BitCode> codes;
+    if (!tree.codeTable(codes)) {
+        return 1;
+    }
+    std::vector<std::pair<std::string, std::string>> codebook;
+    tree.assignCodes(codebook);
+    HuffmanDecoder decoder;
+    decoder.buildTables(codebook);
+    // The decoder numbers symbols by codebook position
+    std::vector<std::uint32_t> positionOf(in.words.size());
+    for (std::size_t i = 0; i < codebook.size(); ++i) {
+        positionOf[std::ranges::lower_bound(in.storage, codebook[i].first) - in.storage.begin()] =
+            static_cast<std::uint32_t>(i);
+    }
+    std::vector<std::uint32_t> expected(in.symbols.size());
+    for (std::size_t t = 0; t < expected.size(); ++t) expected[t] = positionOf[in.symbols[t]];
+
+    std::ostringstream binary;
+    tree.encode(in.symbols, binary, CodeFormat::BINARY);
+    std::vector<unsigned char> bytes;
+    std::uint64_t bitCount = 0;
+    std::istringstream binaryIn(binary.str());
+    readCodeFile(binaryIn, CodeFormat::BINARY, bytes, bitCount);
+    std::vector<std::uint32_t> symbols;
+    const double binaryMs = timeMs(3, [&] { decoder.decodeSymbols(bytes, bitCount, symbols); });
+
+    ThreadPool pool(threads);
+    std::cout << "# " << in.symbols.size() << " tokens, binary .code " << binary.str().size()
+              << " bytes, serial decode " << std::fixed << std::setprecision(1) << binaryMs << " ms, "
+              << pool.size() << " threads\n";
+    std::cout << std::setw(8) << "block" << std::setw(8) << "blocks" << std::setw(12) << "overhead B"
+              << std::setw(10) << "overhead" << std::setw(11) << "serial ms" << std::setw(13) << "parallel ms"
+              << std::setw(9) << "speedup" << std::setw(10) << "seek us" << "\n";
+    for (std::uint64_t perBlock : {4096u, 16384u, 65536u, 262144u}) {
+        std::ostringstream os;
+        BlockWriter writer(os, perBlock);
+        for (std::uint32_t s : in.symbols) writer.putBits(codes[s]);
+        writer.finish();
+        const std::string file = std::move(os).str();
+        const auto* data = reinterpret_cast<const unsigned char*>(file.data());
+        std::vector<CodeBlock> blocks;
+        std::uint64_t tokens = 0;
+        if (readBlockIndex(data, file.size(), blocks, tokens) != NO_ERROR) {
+            std::cerr << "Blocked file with " << perBlock << " tokens per block does not parse\n";
+            return 1;
+        }
+
+        const double serialMs = timeMs(3, [&] { decodeBlocks(decoder, data, blocks, tokens, symbols); });
+        const bool serialOk = symbols == expected;
+        const double parallelMs = timeMs(3, [&] { decodeBlocks(decoder, data, blocks, tokens, symbols, pool); });
+        if (!serialOk || symbols != expected) {
+            std::cerr << "Blocked decode differs with " << perBlock << " tokens per block\n";
+            return 1;
+        }
+        std::mt19937_64 rng(perBlock);
+        constexpr int SEEKS = 200;
+        std::uint32_t symbol = 0;
+        const double seekMs = timeMs(1, [&] {
+            for (int i = 0; i < SEEKS; ++i) decodeToken(decoder, data, blocks, rng() % tokens, symbol);
+        });
+
+        const auto overhead = static_cast<std::int64_t>(file.size()) - static_cast<std::int64_t>(binary.str().size());
+        std::cout << std::setw(8) << perBlock << std::setw(8) << blocks.size() << std::setw(12) << overhead
+                  << std::setprecision(3) << std::setw(9)
+                  << 100.0 * static_cast<double>(overhead) / static_cast<double>(binary.str().size()) << "%"
+                  << std::setprecision(1) << std::setw(11) << serialMs << std::setw(13) << parallelMs
+                  << std::setprecision(2) << std::setw(8) << serialMs / parallelMs << "x"
+                  << std::setprecision(1) << std::setw(10) << seekMs * 1000.0 / SEEKS << "\n";
+    }
+    return 0;
+}
+
+// Batch mode scaling: input_output/*.txt plus one large file, all compressed
+// by compressBatch() on 1, 2, 4, ... threads; every run must write the same .code files
+int benchBatch(std::size_t megabytes, unsigned maxThreads) {
+    namespace fs = std::filesystem;
+    const fs::path work = fs::temp_directory_path() / "huffman_bench_batch";
+    fs::create_directories(work);
+    std::vector<fs::path> files;
+    for (const auto& path : corpusFiles("input_output")) {
+        fs::copy_file(path, work / path.filename(), fs::copy_options::overwrite_existing);
+        files.push_back(work / path.filename());
+    }
+    {
+        const std::string text = repeatedCorpus("input_output", megabytes << 20);
+        std::ofstream(work / "large.txt", std::ios::binary).write(text.data(), static_cast<std::streamsize>(text.size()));
+        files.push_back(work / "large.txt");
+    }
+    double mb = 0;
+    for (const auto& path : files) {
+        mb += static_cast<double>(fs::file_size(path)) / (1024.0 * 1024.0);
+    }
+    auto readCodes = [&] {
+        std::vector<std::string> codes;
+        for (const auto& path : files) {
+            std::ifstream in(fs::path(path).replace_extension(".code"), std::ios::binary);
+            codes.emplace_back(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+        return codes;
+    };
+
+    std::cout << std::fixed << std::setprecision(1) << files.size() << " files, " << mb << " MB (one "
+              << megabytes << " MB file)\n";
+    std::cout << std::setw(8) << "threads" << std::setw(12) << "ms" << std::setw(12) << "MB/s"
+              << std::setw(10) << "speedup" << "\n";
+    std::vector<std::string> serialCodes;
+    double serialMs = 0;
+    for (unsigned t = 1; t <= maxThreads; t = (t == maxThreads || 2 * t <= maxThreads) ? 2 * t : maxThreads) {
+        NullBuffer sink;
+        std::ostream report(&sink);
+        const PipelineOptions options{.threads = static_cast<int>(t), .writeTokens = false};
+        const double ms = timeMs(3, [&] { compressBatch(files, options, report); });
+        if (t == 1) {
+            serialCodes = readCodes();
+            serialMs = ms;
+        } else if (readCodes() != serialCodes) {
+            std::cerr << "Batch on " << t << " threads wrote different .code files\n";
+            return 1;
+        }
+        std::cout << std::setw(8) << t << std::setw(12) << ms << std::setw(12) << mb / (ms / 1000.0)
+                  << std::setprecision(2) << std::setw(9) << serialMs / ms << "x\n" << std::setprecision(1);
+    }
+    fs::remove_all(work);
+    return 0;
+}
+
+// --cache cold vs. warm: per file, a full run with no <base>.meta, a model
+// hit (format switched, so .code is re-encoded from <base>.hdr) and a full
+// hit (.code current: hash the input and the outputs, then stop)
+int benchCache(std::size_t megabytes) {
+    namespace fs = std::filesystem;
+    const fs::path work = fs::temp_directory_path() / "huffman_bench_cache";
+    fs::create_directories(work);
+    std::vector<fs::path> files;
+    for (const auto& path : corpusFiles("input_output")) {
+        fs::copy_file(path, work / path.filename(), fs::copy_options::overwrite_existing);
+        files.push_back(work / path.filename());
+    }
+    {
+        const std::string text = repeatedCorpus("input_output", megabytes << 20);
+        std::ofstream(work / "large.txt", std::ios::binary).write(text.data(), static_cast<std::streamsize>(text.size()));
+        files.push_back(work / "large.txt");
+    }
+
+    NullBuffer sink;
+    std::ostream report(&sink);
+    std::cout << std::left << std::setw(40) << "file" << std::right << std::setw(10) << "KB"
+              << std::setw(11) << "cold ms" << std::setw(13) << "model hit" << std::setw(11) << "hit ms"
+              << std::setw(10) << "speedup" << "\n" << std::fixed;
+    for (const fs::path& file : files) {
+        PipelineOptions options{.cache = true};
+        const fs::path meta = fs::path(file).replace_extension(".meta");
+        const double coldMs = timeMs(3, [&] {
+            fs::remove(meta);
+            compressFile(file, work, options, report);
+        });
+        const double modelMs = timeMs(3, [&] {
+            options.codeFormat = options.codeFormat == CodeFormat::ASCII ? CodeFormat::BINARY : CodeFormat::ASCII;
+            compressFile(file, work, options, report);
+        });
+        const double hitMs = timeMs(3, [&] { compressFile(file, work, options, report); });
+        std::cout << std::left << std::setw(40) << file.filename().string() << std::right << std::setprecision(1)
+                  << std::setw(10) << static_cast<double>(fs::file_size(file)) / 1024.0 << std::setprecision(3)
+                  << std::setw(11) << coldMs << std::setw(13) << modelMs << std::setw(11) << hitMs
+                  << std::setprecision(1) << std::setw(9) << coldMs / hitMs << "x\n";
+    }
+    fs::remove_all(work);
+    return 0;
+}
+
+} // End of namespace
+
+int main(int argc, char* argv[]) {
+    const std::string_view mode = argc > 1 ? argv[1] : "build";
+    if (mode == "build") {
+        const std::size_t maxVocabulary = argc > 2 ? std::stoul(argv[2]) : 1024000;
+        return benchBuild(maxVocabulary);
+    }
+    if (mode == "scan") {
+        return benchScan(argc > 2 ? argv[2] : "input_output");
+    }
+    if (mode == "verify-scan") {
+        return verifyScan(argc > 2 ? std::stoul(argv[2]) : 20000);
+    }
+    if (mode == "scan-threads") {
+        const std::size_t megabytes = argc > 2 ? std::stoul(argv[2]) : 64;
+        const unsigned maxThreads = argc > 3 ? static_cast<unsigned>(std::stoul(argv[3])) : ThreadPool::hardwareThreads();
+        return benchScanThreads(megabytes, maxThreads);
+    }
+    if (mode == "count") {
+        const std::size_t megabytes = argc > 2 ? std::stoul(argv[2]) : 16;
+        const std::size_t vocabulary = argc > 3 ? std::stoul(argv[3]) : 200000;
+        return benchCount(megabytes, vocabulary);
+    }
+    if (mode == "tree") {
+        return benchTree(argc > 2 ? std::stoul(argv[2]) : 1);
+    }
+    if (mode == "layout") {
+        const std::size_t megabytes = argc > 2 ? std::stoul(argv[2]) : 32;
+        const std::size_t vocabulary = argc > 3 ? std::stoul(argv[3]) : 1000000;
+        return benchLayout(megabytes, vocabulary);
+    }
+    if (mode == "encode") {
+        return benchEncode(argc > 2 ? std::stoul(argv[2]) : 64);
+    }
+    if (mode == "encode-threads") {
+        const std::size_t megabytes = argc > 2 ? std::stoul(argv[2]) : 64;
+        const unsigned maxThreads = argc > 3 ? static_cast<unsigned>(std::stoul(argv[3])) : ThreadPool::hardwareThreads();
+        return benchEncodeThreads(megabytes, maxThreads);
+    }
+    if (mode == "blocks") {
+        const std::size_t megabytes = argc > 2 ? std::stoul(argv[2]) : 64;
+        const unsigned threads = argc > 3 ? static_cast<unsigned>(std::stoul(argv[3])) : ThreadPool::hardwareThreads();
+        return benchBlocks(megabytes, threads);
+    }
+    if (mode == "batch") {
+        const std::size_t megabytes = argc > 2 ? std::stoul(argv[2]) : 32;
+        const unsigned maxThreads = argc > 3 ? static_cast<unsigned>(std::stoul(argv[3])) : ThreadPool::hardwareThreads();
+        return benchBatch(megabytes, maxThreads);
+    }
+    if (mode == "cache") {
+        return benchCache(argc > 2 ? std::stoul(argv[2]) : 32);
+    }
+    if (mode == "suite") {
+        return runSuite(argc, argv);
+    }
+    if (mode == "alloc") {
+        return benchAlloc(argc > 2 ? std::stoul(argv[2]) : 1000000);
+    }
+#ifdef HUFFMAN_BENCH_HAS_FORK
+    if (mode == "pipeline") {
+        return benchPipeline(argc > 2 ? std::stoul(argv[2]) : 32);
+    }
+#endif
+    std::cerr << "Usage: " << argv[0] << " build [max_vocabulary] | scan [corpus_dir] | verify-scan [random_cases]"
+              << " | scan-threads [size_mb] [max_threads] | count [size_mb] [vocabulary]"
+              << " | tree [size_mb] | pipeline [size_mb] | alloc [vocabulary]"
+              << " | layout [size_mb] [vocabulary] | encode [size_mb]"
+              << " | encode-threads [size_mb] [max_threads] | blocks [size_mb] [threads]"
+              << " | batch [size_mb] [max_threads] | cache [size_mb]"
+              << " | suite [--zipf=MB:VOCAB] [--reps=N] [--json=FILE] [--baseline=FILE] [--tolerance=F]\n";
+    return 1;
+}
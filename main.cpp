@@ -1,33 +1,253 @@
+#include <algorithm>
 #include <filesystem>
 #include <string>
-#include <vector>
-#include <fstream>
 #include <iostream>
-#include "BinSearchTree.h"
-#include "TreeNode.h"
-#include "PriorityQueue.h"
-#include "HuffmanTree.h"
-#include "Scanner.hpp"
-#include "utils.hpp"
-#include <algorithm>
-#include <random>
-#include <climits> // For INT_MAX
-#include <iomanip>
-
-// Comparison function for sorting word counts (frequency desc, word asc)
-bool compareWordCounts(const std::pair<std::string, int>& a, const std::pair<std::string, int>& b) {
-    if (a.second != b.second) return a.second > b.second; // higher count first
-    return a.first < b.first;                              // alphabetical on ties
+#include <cstdlib>
+#include <new>
+#include <string_view>
+#include <vector>
+#include "Pipeline.h"
+#include "PipelineStats.h"
+
+// Heap allocations feed the --stats allocation counts (a flag test when stats are off)
+void* operator new(std::size_t bytes) {
+    PipelineStats::noteAllocation();
+    if (void* p = std::malloc(bytes == 0 ? 1 : bytes)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void* operator new[](std::size_t bytes) {
+    return ::operator new(bytes);
+}
+
+void operator delete[](void* p) noexcept {
+    ::operator delete(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    ::operator delete(p);
+}
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " <input_output/<base>.txt> [options]\n"
+              << "       " << program << " --batch [<dir>|<file.txt>]... [options]\n"
+              << "              compress every .txt of each directory (default: input_output) and each\n"
+              << "              file, in parallel on --threads threads (default: all cores)\n"
+              << "  --shared-model=FILE  with --batch: one model from all files' counts, saved to FILE (a .hdr);\n"
+              << "              each file gets only <base>.code. Compares sizes and times with per-file models\n"
+              << "  --escape    with --shared-model: add an escape word so files outside the batch can use the model\n"
+              << "Options:\n"
+              << "  --binary    write <base>.code as packed bits (default: ASCII '0'/'1' lines)\n"
+              << "  --blocked   write <base>.code as packed blocks of 65536 tokens with a seek index\n"
+              << "  --canonical use canonical codes and write the compact lengths-only <base>.hdr\n"
+              << "  --max-code-length=N  limit codes to N bits (package-merge); reports the cost vs. unbounded\n"
+              << "  --threads=N tokenize and encode large inputs on N threads (0 = all cores; default 1)\n"
+              << "  --pipeline=interned|streaming|strings  word IDs in memory (default), two passes over the\n"
+              << "              input with no token array, or the original std::string tokens\n"
+              << "  --no-tokens do not write <base>.tokens (interned and streaming pipelines)\n"
+              << "  --layout=pointer|flat  Huffman tree as linked TreeNodes (default) or contiguous index arrays\n"
+              << "  --counter=bst|hash  word-counting engine for --pipeline=strings (default: bst)\n"
+              << "  --decode    read <base>.hdr + <base>.code and write the tokens to <base>.decoded\n"
+              << "              (with --blocked, --threads=N decodes blocks in parallel)\n"
+              << "  --model=FILE  encode with the existing model FILE (writes only <base>.code; unseen words\n"
+              << "              are escaped if the model has an escape word); with --decode: decode with FILE\n"
+              << "              instead of <base>.hdr\n"
+              << "  --seek=N    with --decode --blocked: decode only the block holding token N and print it\n"
+              << "  --adaptive  one-pass adaptive Huffman: write <base>.acode as tokens are read, no .freq/.hdr\n"
+              << "              (with --decode: <base>.acode -> <base>.decoded). Give '-' as the file to\n"
+              << "              stream standard input to standard output, flushed after every line (both ways)\n"
+              << "  --cache     record the input's xxHash64 and the outputs' hashes in <base>.meta; when they\n"
+              << "              still match, skip the run (or, if only .code is stale, encode from <base>.hdr)\n"
+              << "  --merge=FILE  add the counts of FILE (a .freq, e.g. of appended text) to <base>.freq and\n"
+              << "              rebuild <base>.hdr only if its codes now cost more than the threshold over the entropy\n"
+              << "              (a rebuild re-encodes an existing <base>.code from the input; <base>.meta is removed)\n"
+              << "  --rebuild-threshold=F  with --merge: the fraction over the entropy that triggers a rebuild\n"
+              << "              (default 0.05)\n"
+              << "  --stats[=json]  after compressing, print each stage's wall time, bytes in/out, token and\n"
+              << "              distinct-word counts, peak RSS and heap allocations (as a table or JSON)\n";
+}
+
+// --batch arguments: directories expand to their .txt files, in name order
+std::vector<std::filesystem::path> batchFiles(const std::vector<std::filesystem::path>& args) {
+    namespace fs = std::filesystem;
+    std::vector<fs::path> files;
+    for (const fs::path& arg : args) {
+        std::error_code ec;
+        if (!fs::is_directory(arg, ec)) {
+            files.push_back(arg);
+            continue;
+        }
+        std::vector<fs::path> inDir;
+        for (const auto& entry : fs::directory_iterator(arg, ec)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".txt") {
+                inDir.push_back(entry.path());
+            }
+        }
+        std::ranges::sort(inDir);
+        files.insert(files.end(), inDir.begin(), inDir.end());
+    }
+    return files;
 }
 
 int main(int argc, char* argv[]) {
 
     // Command Line check
-    if (argc != 2) {
-        std::cerr << "Usage: " << argv[0] << " <input_output/<base>.txt>\n";
+    if (argc < 2) {
+        printUsage(argv[0]);
         return 1;
     }   
 
+    // Batch mode takes any number of inputs before the options
+    const bool batchMode = std::string_view(argv[1]) == "--batch";
+    std::vector<std::filesystem::path> batchArgs;
+    int firstOption = 2;
+    if (batchMode) {
+        for (; firstOption < argc && !std::string_view(argv[firstOption]).starts_with("--"); ++firstOption) {
+            batchArgs.emplace_back(argv[firstOption]);
+        }
+    }
+
+    // Options after the input file name
+    PipelineOptions options;
+    bool threadsGiven = false;
+    bool decodeMode = false;
+    long long seekToken = -1;
+    bool statsOn = false;
+    bool statsJson = false;
+    std::filesystem::path sharedModel;
+    std::filesystem::path decodeModel;
+    bool escape = false;
+    bool adaptive = false;
+    std::filesystem::path mergePath;
+    for (int i = firstOption; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--binary") {
+            options.codeFormat = CodeFormat::BINARY;
+        }
+        else if (arg == "--blocked") {
+            options.codeFormat = CodeFormat::BLOCKED;
+        }
+        else if (arg == "--canonical") {
+            options.canonical = true;
+        }
+        else if (arg.starts_with("--max-code-length=")) {
+            options.maxCodeLength = std::atoi(arg.substr(arg.find('=') + 1).data());
+            if (options.maxCodeLength <= 0) {
+                std::cerr << "Invalid code length limit: " << arg << "\n";
+                return 1;
+            }
+        }
+        else if (arg.starts_with("--threads=")) {
+            options.threads = std::atoi(arg.substr(arg.find('=') + 1).data());
+            threadsGiven = true;
+            if (options.threads < 0) {
+                std::cerr << "Invalid thread count: " << arg << "\n";
+                return 1;
+            }
+        }
+        else if (arg == "--counter=bst" || arg == "--counter=hash") {
+            options.counter = arg.ends_with("hash") ? CounterKind::HASH : CounterKind::BST;
+        }
+        else if (arg == "--pipeline=interned") {
+            options.kind = PipelineKind::INTERNED;
+        }
+        else if (arg == "--pipeline=streaming") {
+            options.kind = PipelineKind::STREAMING;
+        }
+        else if (arg == "--pipeline=strings") {
+            options.kind = PipelineKind::STRINGS;
+        }
+        else if (arg == "--no-tokens") {
+            options.writeTokens = false;
+        }
+        else if (arg == "--layout=pointer" || arg == "--layout=flat") {
+            options.layout = arg.ends_with("flat") ? TreeLayout::FLAT : TreeLayout::POINTER;
+        }
+        else if (arg == "--decode") {
+            decodeMode = true;
+        }
+        else if (arg.starts_with("--seek=")) {
+            seekToken = std::atoll(arg.substr(arg.find('=') + 1).data());
+            if (seekToken < 0) {
+                std::cerr << "Invalid token number: " << arg << "\n";
+                return 1;
+            }
+        }
+        else if (arg.starts_with("--shared-model=") && arg.size() > 15) {
+            sharedModel = arg.substr(15);
+        }
+        else if (arg.starts_with("--model=") && arg.size() > 8) {
+            decodeModel = arg.substr(8);
+        }
+        else if (arg == "--escape") {
+            escape = true;
+        }
+        else if (arg == "--adaptive") {
+            adaptive = true;
+        }
+        else if (arg == "--cache") {
+            options.cache = true;
+        }
+        else if (arg.starts_with("--merge=") && arg.size() > 8) {
+            mergePath = arg.substr(8);
+        }
+        else if (arg.starts_with("--rebuild-threshold=")) {
+            options.rebuildThreshold = std::atof(arg.substr(arg.find('=') + 1).data());
+            if (options.rebuildThreshold < 0) {
+                std::cerr << "Invalid rebuild threshold: " << arg << "\n";
+                return 1;
+            }
+        }
+        else if (arg == "--stats" || arg == "--stats=json") {
+            statsOn = true;
+            statsJson = arg.ends_with("json");
+        }
+        else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+
+    if (batchMode) {
+        if (decodeMode || statsOn || adaptive) {
+            std::cerr << "--batch only compresses (no --decode, --stats or --adaptive)\n";
+            return 1;
+        }
+        const std::vector<std::filesystem::path> files =
+            batchFiles(batchArgs.empty() ? std::vector<std::filesystem::path>{"input_output"} : batchArgs);
+        if (files.empty()) {
+            std::cerr << "No .txt files to compress\n";
+            return 1;
+        }
+        if (!sharedModel.empty()) {
+            options.escape = escape;
+            return compressShared(files, sharedModel, options, std::cout);
+        }
+        if (!threadsGiven) {
+            options.threads = 0; // all cores
+        }
+        return compressBatch(files, options, std::cout);
+    }
+    if (!sharedModel.empty()) {
+        std::cerr << "--shared-model needs --batch\n";
+        return 1;
+    }
+    if (escape) {
+        std::cerr << "--escape needs --batch --shared-model\n";
+        return 1;
+    }
 
     /**
      * Path setup
@@ -44,173 +264,63 @@ int main(int argc, char* argv[]) {
     const fs::path inPath = dir / argv[1];
     const std::string base = inPath.stem().string();
 
-
-    // Derived file for Part 1 (.tokens)
-    const fs::path tokensPath = dir / (base + ".tokens");
-
-
-
-
-    // SAFTEY CHECKS
-    // Pre-flight checks using your utils (as your starter did)
-    if (error_type st; (st = regularFileExistsAndIsAvailable(inPath.string())) != NO_ERROR)
-        exitOnError(st, inPath.string());
-    if (error_type st; (st = directoryExists(dir.string())) != NO_ERROR)
-        exitOnError(st, dir.string());
-    if (error_type st; (st = canOpenForWriting(tokensPath.string())) != NO_ERROR)
-        exitOnError(st, tokensPath.string());
-
-    // Scanning and writing
-    std::vector<std::string> words;
-    Scanner scanner(inPath); // IMPORTANT: pass the INPUT .txt here
-
-    // Option A (keep your utils writer):
-    if (error_type st; (st = scanner.tokenize(words)) != NO_ERROR)
-        exitOnError(st, inPath.string());
-    if (error_type st; (st = writeVectorToFile(tokensPath.string(), words)) != NO_ERROR)
-        exitOnError(st, tokensPath.string());
-
-
-
-    // Part 2 TESTING
-    // BinSearchTree Section
-    // Testing BinSearchTree Function
-    std::vector<std::string> tokens; // holds tokens
-    std::ifstream inTokens(tokensPath);
-    std::string word;
-
-    // Read in all tokens from the .tokens file and push them into the tokens vector
-    while (inTokens >> word) {
-        tokens.push_back(word);
+    // Fold a .freq delta into <base>.freq, rebuilding <base>.hdr only on drift
+    if (!mergePath.empty()) {
+        if (decodeMode || adaptive || statsOn || !decodeModel.empty()) {
+            std::cerr << "--merge takes no --decode, --adaptive, --stats or --model\n";
+            return 1;
+        }
+        return updateModel(inPath, dir, mergePath, options, std::cout);
     }
 
-    // Shuffle the tokens to simulate random insertion (Used Provided Seed in project spec)
-    constexpr unsigned SEED = 0xC0FFEE;
-    std::mt19937 rng(SEED);
-    std::shuffle(tokens.begin(), tokens.end(), rng);
-
-    // Build the binary search tree
-    BinSearchTree bst;
-    bst.bulkInsert(tokens);
-
-    // In-order traversal to collect words and counts
-    std::vector<std::pair<std::string, int>> wordCounts;
-    // Should be sorted alphabetically with this call
-    bst.inorderCollect(wordCounts);
-
-    // frequency
-    int minFreq = INT_MAX;
-    int maxFreq = 0;
-
-    // Calculate min and max frequency
-    for (const std::pair<std::string, int>& word : wordCounts) {
-        minFreq = std::min(minFreq, word.second);
-        maxFreq = std::max(maxFreq, word.second);
+    // Adaptive mode has no model files; "-" streams stdin to stdout
+    if (adaptive) {
+        if (statsOn || !decodeModel.empty()) {
+            std::cerr << "--adaptive takes no --stats or --model\n";
+            return 1;
+        }
+        const bool piped = std::string_view(argv[1]) == "-";
+        const fs::path codePath = piped ? fs::path("-") : dir / (base + ".acode");
+        std::ostream& report = piped ? std::cerr : std::cout;
+        if (decodeMode) {
+            return decodeAdaptive(codePath, piped ? fs::path("-") : dir / (base + ".decoded"), report);
+        }
+        return compressAdaptive(piped ? fs::path("-") : inPath, codePath, report);
     }
-    // Print out results
-    std::cout << "BST height: " << bst.height() << "\n";
-    std::cout << "BST unique words: " << bst.size() << "\n";
-    std::cout << "Total tokens: " << tokens.size() << "\n";
-    std::cout << "Min frequency: " << minFreq << "\n";
-    std::cout << "Max frequency: " << maxFreq << "\n";
-
-
-
-    /**
-     * Priority Queue Section
-    */
 
-    // === Write <base>.freq next to the .tokens file ===
-    const fs::path freqPath = dir / (base + ".freq");
-    if (error_type st; (st = canOpenForWriting(freqPath.string())) != NO_ERROR)
-        exitOnError(st, freqPath.string());
 
-    // Write frequency file (sorted by count desc, word asc)
-    auto sorted = wordCounts;
-    std::sort(sorted.begin(), sorted.end(), compareWordCounts); // Created comparison function in utils.h/cpp 
-
-    std::ofstream freqOut(freqPath);
-    for (const auto& [w, c] : sorted) {
-        freqOut << std::setw(10) << c << ' ' << w << '\n';  // exactly one space
+    // Decoding only needs the .hdr and .code files
+    if (decodeMode) {
+        if (seekToken >= 0 && options.codeFormat != CodeFormat::BLOCKED) {
+            std::cerr << "--seek needs a --blocked .code file\n";
+            return 1;
+        }
+        if (statsOn) {
+            std::cerr << "--stats only applies to compression\n";
+            return 1;
+        }
+        return decodeFile(dir, base, {.codeFormat = options.codeFormat, .threads = options.threads,
+                                      .seekToken = seekToken, .modelPath = decodeModel}, std::cout);
     }
-    freqOut.close();
-    
-
-
-
-
 
-    // Build
-    HuffmanTree huffmanTree = HuffmanTree::buildFromCounts(wordCounts);
-
-    // Write .hdr file
-    const fs::path hdrPath = dir / (base + ".hdr");
-    if (error_type st; (st = canOpenForWriting(hdrPath.string())) != NO_ERROR)
-        exitOnError(st, hdrPath.string());
-    
-    std::ofstream hdrOut(hdrPath);
-    if (huffmanTree.writeHeader(hdrOut) != NO_ERROR) {
-        std::cerr << "Error writing header file\n";
-        return 1;
+    // Someone else's model: only <base>.code is written
+    if (!decodeModel.empty()) {
+        if (statsOn) {
+            std::cerr << "--stats does not apply to --model\n";
+            return 1;
+        }
+        return compressWithModel(inPath, dir, decodeModel, options, std::cout);
     }
-    hdrOut.close();
-
-    // Write <base>.code 
-    const fs::path codePath = dir / (base + ".code");
-    if (error_type st; (st = canOpenForWriting(codePath.string())) != NO_ERROR)
-        exitOnError(st, codePath.string());
-    
-    std::ofstream codeOut(codePath);
-    if (huffmanTree.encode(words, codeOut) != NO_ERROR) {
-        std::cerr << "Error writing code file\n";
-        return 1;
-    }
-    codeOut.close();
 
-    return 0;
-}
-
-
-
-
-
-
-
-
-
-
-
-
-/**
- * OLD Testing code
- *
- *
- *
-*
-    // Output testing PART 1 of program
-    std::cout << "Tokenization complete. " << words.size() << " tokens found.\n";
-    std::cout << "Tokens written to: " << tokensPath << "\n";
-    std::cout << "----------------------------------------\n";
-
-
- *  //test countOf, and contains
-    if (bst.contains("the")) {
-        std::cout << "The word 'the' is in the tree.\n";
-
-        // Access the count using .value().
-        auto wordCount = bst.countOf("the").value();
-        std::cout << "The word 'the' appears " << wordCount << " times.\n";
+    // Scanner -> counting -> Huffman, writing .tokens/.freq/.hdr/.code next to the input
+    PipelineStats stats;
+    if (statsOn) {
+        PipelineStats::enableAllocationCounting(); // before the pipeline starts any threads
+        options.stats = &stats;
     }
-    else
-        std::cout << "The word 'the' is NOT in the tree.\n";
-
-
-
-// Print out first 15 words to make sure it works.
-    for (int i = 0; i < 15; ++i) {
-        std::cout << wordCounts[i].first << " " << wordCounts[i].second << "\n";
+    const int status = compressFile(inPath, dir, options, std::cout);
+    if (statsOn) {
+        stats.print(std::cout, statsJson);
     }
- *
- *
- *
- */
\ No newline at end of file
+    return status;
+}
@@ -10,32 +10,51 @@
 #include <cctype>
 
 
-void exitOnError(error_type error, const std::string &entityName = "") {
+std::string errorMessage(error_type error, const std::string &entityName) {
     switch (error) {
         case NO_ERROR:
-            // do nothing
-            return;
+            return "";
 
         case FILE_NOT_FOUND:
-            std::cerr << "Error: File " << entityName << " doesn't exist. Terminating...\n";
-            exit(FILE_NOT_FOUND);
+            return "File " + entityName + " doesn't exist";
 
         case UNABLE_TO_OPEN_FILE:
-            std::cerr << "Error: Unable to open '" << entityName << "'. Terminating...\n";
-            exit(UNABLE_TO_OPEN_FILE);
+            return "Unable to open '" + entityName + "'";
 
         case DIR_NOT_FOUND:
-            std::cerr << "Error: Directory " << entityName << " doesn't exist. Terminating...\n";
-            exit(DIR_NOT_FOUND);
+            return "Directory " + entityName + " doesn't exist";
 
         case UNABLE_TO_OPEN_FILE_FOR_WRITING:
-            std::cerr << "Error: Unable to open " << entityName << " for writing. Terminating...\n";
-            exit(UNABLE_TO_OPEN_FILE_FOR_WRITING);
+            return "Unable to open " + entityName + " for writing";
+
+        case FAILED_TO_WRITE_FILE:
+            return "Failed while writing " + entityName;
+
+        case INVALID_HEADER_FILE:
+            return "Header file " + entityName + " is malformed";
+
+        case CORRUPT_CODE_FILE:
+            return "Code file " + entityName + " is corrupt";
+
+        case WORD_NOT_IN_CODEBOOK:
+            return entityName + " has a token with no Huffman code";
+
+        case INVALID_FREQ_FILE:
+            return "Frequency file " + entityName + " is malformed or has a count out of range";
 
         default:
-            std::cerr << "Error: Unknown error type. Terminating...\n";
-            exit(ERR_TYPE_NOT_FOUND);
+            return "Unknown error type";
+    }
+}
+
+void exitOnError(error_type error, const std::string &entityName = "") {
+    if (error == NO_ERROR) {
+        // do nothing
+        return;
     }
+    std::cerr << "Error: " << errorMessage(error, entityName) << ". Terminating...\n";
+    const bool known = error > NO_ERROR && error <= INVALID_FREQ_FILE;
+    exit(known ? error : ERR_TYPE_NOT_FOUND);
 }
 
 error_type directoryExists(const std::string &name) {
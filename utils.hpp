@@ -17,9 +17,14 @@ enum error_type {
     ERR_TYPE_NOT_FOUND,
     UNABLE_TO_OPEN_FILE_FOR_WRITING,
     FAILED_TO_WRITE_FILE,
+    INVALID_HEADER_FILE,
+    CORRUPT_CODE_FILE,
+    WORD_NOT_IN_CODEBOOK,
+    INVALID_FREQ_FILE,
 };
 
 void exitOnError(error_type error, const std::string& entityName);
+std::string errorMessage(error_type error, const std::string& entityName);
 error_type regularFileExistsAndIsAvailable(const std::string &fileName);
 error_type fileExists(const std::string &name);
 error_type directoryExists(const std::string &name);